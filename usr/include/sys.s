@@ -39,13 +39,17 @@ sync	= 36.
 kill	= 37.
 csw	= 38.
 setpgrp	= 39.
+readv	= 40.
 dup	= 41.
 pipe	= 42.
 times	= 43.
 profil	= 44.
+vfork	= 45.
 setgid	= 46.
 getgid	= 47.
 signal	= 48.
+aio	= 49.
+fmap	= 50.
 acct	= 51.
 phys	= 52.
 lock	= 53.
@@ -55,3 +59,4 @@ mpx	= 56.
 setinf	= 59.
 umask	= 60.
 getinf	= 60.
+writev	= 62.
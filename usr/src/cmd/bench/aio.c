@@ -0,0 +1,162 @@
+/*
+ * aiobench - overlapped raw copying
+ * usage: aiobench [ -b bufsize ] [ -k kbytes ] [ -n depth ] in out
+ * Copies kbytes (default 512) from in to out
+ * in transfers of bufsize bytes (default 10240),
+ * first with read and write, then with aio keeping
+ * up to depth transfers (default 2) going on each
+ * side, as dump would to keep both the disk and the
+ * tape streaming.  in and out should be raw devices,
+ * say /dev/rrp0 and /dev/rmt0; on anything else aio
+ * finishes each transfer before it returns, and the
+ * two times should be the same.  Both are opened
+ * afresh for each pass.
+ */
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/times.h>
+#include <sys/uio.h>
+
+#define	MAXBUF	10240
+#define	MAXDEP	2
+#define	HZ	60
+
+int	buf[2*MAXDEP][MAXBUF/2];	/* words, for raw transfers */
+int	bsize	= MAXBUF;
+int	depth	= 2;
+long	nbytes	= 512L*1024L;
+char	*in, *out;
+
+main(argc, argv)
+char **argv;
+{
+
+	while(argc > 1 && argv[1][0] == '-') {
+		if(argc < 3)
+			usage();
+		switch(argv[1][1]) {
+		case 'b':
+			bsize = atoi(argv[2]);
+			break;
+		case 'k':
+			nbytes = atol(argv[2]) * 1024L;
+			break;
+		case 'n':
+			depth = atoi(argv[2]);
+			break;
+		default:
+			usage();
+		}
+		argc -= 2;
+		argv += 2;
+	}
+	if(argc != 3 || bsize <= 0 || bsize > MAXBUF || bsize&01 ||
+	    depth <= 0 || depth > MAXDEP || nbytes < bsize)
+		usage();
+	in = argv[1];
+	out = argv[2];
+	nbytes -= nbytes % bsize;
+	pass(0);
+	pass(1);
+	exit(0);
+}
+
+/*
+ * Copy, with aio if async, and report.
+ */
+pass(async)
+{
+	struct tms t0, t1;
+	time_t r0, r1;
+	long ticks;
+	int fi, fo;
+
+	if((fi = open(in, 0)) < 0 || (fo = open(out, 1)) < 0) {
+		fprintf(stderr, "aiobench: cannot open %s or %s\n", in, out);
+		exit(1);
+	}
+	time(&r0);
+	times(&t0);
+	if(async)
+		acopy(fi, fo);
+	else
+		copy(fi, fo);
+	times(&t1);
+	time(&r1);
+	close(fi);
+	close(fo);
+	r1 -= r0;
+	printf("%s: %D bytes, %d byte transfers", async? "aio": "read/write",
+		nbytes, bsize);
+	if(async)
+		printf(", %d deep", depth);
+	printf("\nreal %D s", r1);
+	if(r1 > 0)
+		printf(", %D bytes/s", nbytes/r1);
+	ticks = t1.tms_stime - t0.tms_stime;
+	printf(", sys %D.%02D s\n", ticks/HZ, ticks%HZ*100/HZ);
+}
+
+copy(fi, fo)
+{
+	long n;
+
+	for(n = 0; n < nbytes; n += bsize) {
+		if(read(fi, (char *)buf[0], bsize) != bsize)
+			fail("read");
+		if(write(fo, (char *)buf[0], bsize) != bsize)
+			fail("write");
+	}
+}
+
+/*
+ * Buffers go round a ring of 2*depth: up to depth
+ * reads are kept started ahead of the writes, and
+ * each buffer's write is collected before the buffer
+ * is read into again.
+ */
+acopy(fi, fo)
+{
+	int rh[2*MAXDEP], wh[2*MAXDEP];
+	long nr, nw, nbuf;
+	int b;
+
+	nbuf = nbytes / bsize;
+	for(b = 0; b < 2*depth; b++)
+		rh[b] = wh[b] = -1;
+	nr = nw = 0;
+	while(nw < nbuf) {
+		while(nr < nbuf && nr-nw < depth) {
+			b = nr % (2*depth);
+			if(wh[b] >= 0 && aio(AIOWAIT, wh[b]) != bsize)
+				fail("write");
+			wh[b] = -1;
+			if((rh[b] = aio(AIOREAD, fi, (char *)buf[b], bsize)) < 0)
+				fail("read");
+			nr++;
+		}
+		b = nw % (2*depth);
+		if(aio(AIOWAIT, rh[b]) != bsize)
+			fail("read");
+		if((wh[b] = aio(AIOWRITE, fo, (char *)buf[b], bsize)) < 0)
+			fail("write");
+		nw++;
+	}
+	for(b = 0; b < 2*depth; b++)
+		if(wh[b] >= 0 && aio(AIOWAIT, wh[b]) != bsize)
+			fail("write");
+}
+
+fail(s)
+char *s;
+{
+
+	fprintf(stderr, "aiobench: %s failed\n", s);
+	exit(1);
+}
+
+usage()
+{
+	fprintf(stderr, "usage: aiobench [ -b bufsize ] [ -k kbytes ] [ -n depth ] in out\n");
+	exit(1);
+}
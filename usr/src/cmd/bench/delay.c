@@ -0,0 +1,105 @@
+/*
+ * delaybench - callout (timeout) load
+ * usage: delaybench [ -n lines ] tty ...
+ * One writer per terminal line named sends lines
+ * (default 1000) newlines with the vt05 newline
+ * delay set, so that every newline has the driver
+ * arrange a timeout to restart output.  With many
+ * lines the callout table holds a timeout for each,
+ * all being inserted and expiring at once.
+ * User programs cannot arrange callouts themselves;
+ * the terminal delays are the nearest way in.
+ */
+#include <stdio.h>
+#include <sgtty.h>
+#include <sys/types.h>
+#include <sys/times.h>
+
+#define	HZ	60
+
+long	nlines	= 1000;
+
+main(argc, argv)
+char **argv;
+{
+	struct tms tb;
+	time_t t0, t1;
+	long ticks;
+	int ntty, i, status, fail;
+
+	while(argc > 1 && argv[1][0] == '-') {
+		if(argv[1][1] != 'n' || argc < 3)
+			usage();
+		nlines = atol(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+	ntty = argc-1;
+	if(ntty <= 0 || nlines <= 0)
+		usage();
+	time(&t0);
+	for(i = 1; i < argc; i++)
+		switch(fork()) {
+		case -1:
+			fprintf(stderr, "delaybench: cannot fork\n");
+			exit(1);
+		case 0:
+			writer(argv[i]);
+			exit(0);
+		}
+	fail = 0;
+	while(wait(&status) != -1)
+		if(status != 0)
+			fail++;
+	time(&t1);
+	times(&tb);
+	t1 -= t0;
+	if(fail)
+		exit(1);
+	printf("%d lines, %D delayed newlines each\n", ntty, nlines);
+	printf("real %D s", t1);
+	if(t1 > 0)
+		printf(", %D timeouts/s", nlines*ntty/t1);
+	printf("\n");
+	ticks = tb.tms_cstime;
+	printf("sys %D.%02D s\n", ticks/HZ, ticks%HZ*100/HZ);
+	exit(0);
+}
+
+/*
+ * Write the newlines to one terminal,
+ * restoring its modes afterwards.
+ */
+writer(tty)
+char *tty;
+{
+	struct sgttyb old, new;
+	register fd;
+	long n;
+
+	if((fd = open(tty, 1)) < 0) {
+		fprintf(stderr, "delaybench: cannot open %s\n", tty);
+		exit(1);
+	}
+	if(gtty(fd, &old) < 0) {
+		fprintf(stderr, "delaybench: %s not a terminal\n", tty);
+		exit(1);
+	}
+	new = old;
+	new.sg_flags &= ~(NLDELAY|RAW|ECHO);
+	new.sg_flags |= NL2;
+	stty(fd, &new);
+	for(n = 0; n < nlines; n++)
+		if(write(fd, "\n", 1) != 1) {
+			fprintf(stderr, "delaybench: write error on %s\n", tty);
+			stty(fd, &old);
+			exit(1);
+		}
+	stty(fd, &old);
+}
+
+usage()
+{
+	fprintf(stderr, "usage: delaybench [ -n lines ] tty ...\n");
+	exit(1);
+}
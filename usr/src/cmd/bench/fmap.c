@@ -0,0 +1,142 @@
+/*
+ * fmapbench - mapped file access against read
+ * usage: fmapbench [ -s segreg ] [ file [ count ] ]
+ * Counts the newlines in file (default /usr/dict/words)
+ * count times (default 10), first reading it with read
+ * into a buffer of a block, then through fmap a segment
+ * of 8K at a time, mapped at segreg*8K (default 4).
+ */
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/times.h>
+
+#define	HZ	60
+#define	SEGSIZ	8192L
+
+char	*file	= "/usr/dict/words";
+int	seg	= 4;
+char	buf[512];
+
+main(argc, argv)
+char **argv;
+{
+	struct stat sb;
+	long nl1, nl2, t1, t2;
+	int fd, count, i;
+
+	count = 10;
+	while(argc > 1 && argv[1][0] == '-') {
+		if(argv[1][1] != 's' || argc < 3)
+			usage();
+		seg = atoi(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+	if(argc > 1)
+		file = argv[1];
+	if(argc > 2)
+		count = atoi(argv[2]);
+	if(count <= 0 || seg < 0 || seg > 7)
+		usage();
+	if((fd = open(file, 0)) < 0) {
+		fprintf(stderr, "fmapbench: cannot open %s\n", file);
+		exit(1);
+	}
+	fstat(fd, &sb);
+	t1 = cpu();
+	for(i = 0; i < count; i++)
+		nl1 = byread(fd);
+	t1 = cpu() - t1;
+	t2 = cpu();
+	for(i = 0; i < count; i++)
+		nl2 = bymap(fd, sb.st_size);
+	t2 = cpu() - t2;
+	if(nl1 != nl2) {
+		fprintf(stderr, "fmapbench: %D lines by read, %D by fmap\n",
+			nl1, nl2);
+		exit(1);
+	}
+	printf("%D bytes, %D lines, %d passes\n", sb.st_size, nl1, count);
+	report("read", t1, sb.st_size*count);
+	report("fmap", t2, sb.st_size*count);
+	exit(0);
+}
+
+/*
+ * Count the lines with read.
+ */
+long
+byread(fd)
+{
+	register char *p;
+	register n;
+	long nl;
+
+	lseek(fd, 0L, 0);
+	nl = 0;
+	while((n = read(fd, buf, sizeof buf)) > 0)
+		for(p = buf; --n >= 0;)
+			if(*p++ == '\n')
+				nl++;
+	return(nl);
+}
+
+/*
+ * Count the lines through successive
+ * 8K windows mapped with fmap.
+ */
+long
+bymap(fd, size)
+long size;
+{
+	register char *p, *e;
+	long off, nl, n;
+	char *fmap();
+
+	nl = 0;
+	for(off = 0; off < size; off += SEGSIZ) {
+		p = (char *)fmap(fd, seg, (int)(off>>9));
+		if(p == (char *)-1) {
+			fprintf(stderr, "fmapbench: cannot map segment %d\n", seg);
+			exit(1);
+		}
+		n = size - off;
+		if(n > SEGSIZ)
+			n = SEGSIZ;
+		for(e = p + (int)n; p < e;)
+			if(*p++ == '\n')
+				nl++;
+		fmap(-1, seg, 0);
+	}
+	return(nl);
+}
+
+/*
+ * User and system time used so far, in ticks.
+ */
+long
+cpu()
+{
+	struct tms tb;
+
+	times(&tb);
+	return(tb.tms_utime + tb.tms_stime);
+}
+
+report(s, t, nbytes)
+char *s;
+long t, nbytes;
+{
+
+	printf("%s: cpu %D.%02D s", s, t/HZ, t%HZ*100/HZ);
+	if(t > 0)
+		printf(", %D bytes/s", nbytes*HZ/t);
+	printf("\n");
+}
+
+usage()
+{
+	fprintf(stderr, "usage: fmapbench [ -s segreg ] [ file [ count ] ]\n");
+	exit(1);
+}
@@ -0,0 +1,142 @@
+/*
+ * pipebench - pipeline throughput
+ * usage: pipebench [ -s stages ] [ -b bufsize ] [ kbytes ]
+ * A writer sends kbytes (default 1024) through stages
+ * copying processes (default 3) to a reader, like
+ * sort | uniq | tbl | troff, each process joined to the
+ * next by a pipe and using reads and writes of bufsize
+ * bytes (default 512).
+ */
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/times.h>
+
+#define	MAXBUF	8192
+#define	HZ	60
+
+char	buf[MAXBUF];
+int	bsize	= 512;
+int	nstage	= 3;
+long	nbytes	= 1024L*1024L;
+
+main(argc, argv)
+char **argv;
+{
+	struct tms tb;
+	time_t t0, t1;
+	long ticks;
+	int status;
+
+	while(argc > 1 && argv[1][0] == '-') {
+		if(argc < 3)
+			usage();
+		switch(argv[1][1]) {
+		case 's':
+			nstage = atoi(argv[2]);
+			break;
+		case 'b':
+			bsize = atoi(argv[2]);
+			break;
+		default:
+			usage();
+		}
+		argc -= 2;
+		argv += 2;
+	}
+	if(argc > 1)
+		nbytes = atol(argv[1]) * 1024L;
+	if(nstage < 0 || bsize <= 0 || bsize > MAXBUF || nbytes <= 0)
+		usage();
+	time(&t0);
+	switch(fork()) {
+	case -1:
+		fprintf(stderr, "pipebench: cannot fork\n");
+		exit(1);
+	case 0:
+		stage(nstage+1);
+		exit(0);
+	}
+	wait(&status);
+	time(&t1);
+	times(&tb);
+	t1 -= t0;
+	printf("%D bytes, %d pipes, %d byte transfers\n",
+		nbytes, nstage+1, bsize);
+	printf("real %D s", t1);
+	if(t1 > 0)
+		printf(", %D bytes/s", nbytes/t1);
+	printf("\n");
+	ticks = tb.tms_cutime;
+	printf("user %D.%02D s", ticks/HZ, ticks%HZ*100/HZ);
+	ticks = tb.tms_cstime;
+	printf(", sys %D.%02D s\n", ticks/HZ, ticks%HZ*100/HZ);
+	exit(status != 0);
+}
+
+/*
+ * Become process n of the pipeline:
+ * 0 is the writer, nstage+1 the reader,
+ * and the rest copy.  Each process makes
+ * the pipe on its standard input and forks
+ * the process before it to write it.
+ */
+stage(n)
+{
+	int p[2], status;
+	register c;
+	long count;
+
+	if(n > 0) {
+		if(pipe(p) < 0) {
+			fprintf(stderr, "pipebench: cannot make pipe\n");
+			exit(1);
+		}
+		switch(fork()) {
+		case -1:
+			fprintf(stderr, "pipebench: cannot fork\n");
+			exit(1);
+		case 0:
+			close(1);
+			dup(p[1]);
+			close(p[0]);
+			close(p[1]);
+			stage(n-1);
+			exit(0);
+		}
+		close(0);
+		dup(p[0]);
+		close(p[0]);
+		close(p[1]);
+	}
+	if(n == 0) {
+		for(count = nbytes; count > 0; count -= c) {
+			c = count < bsize? count: bsize;
+			if(write(1, buf, c) != c) {
+				fprintf(stderr, "pipebench: write error\n");
+				exit(1);
+			}
+		}
+		return;
+	}
+	if(n <= nstage) {
+		while((c = read(0, buf, bsize)) > 0)
+			write(1, buf, c);
+		close(1);
+	} else {
+		count = 0;
+		while((c = read(0, buf, bsize)) > 0)
+			count += c;
+		if(count != nbytes) {
+			fprintf(stderr, "pipebench: read %D bytes\n", count);
+			exit(1);
+		}
+	}
+	while(wait(&status) != -1)
+		;
+}
+
+usage()
+{
+	fprintf(stderr, "usage: pipebench [ -s stages ] [ -b bufsize ] [ kbytes ]\n");
+	exit(1);
+}
@@ -0,0 +1,99 @@
+/*
+ * spawnbench - command launch rate
+ * usage: spawnbench [ -v ] [ -k kbytes ] [ count [ command ] ]
+ * Runs command (default /bin/echo) count times
+ * (default 100) as the shell does: fork, redirect
+ * the output to /dev/null, exec and wait.
+ * -v uses vfork instead of fork.  The launching
+ * process is first grown to kbytes of data
+ * (default 16), the size of a typical shell.
+ */
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/times.h>
+
+#define	HZ	60
+
+char	*cmd	= "/bin/echo";
+int	vflg;
+
+main(argc, argv)
+char **argv;
+{
+	struct tms tb;
+	time_t t0, t1;
+	long ticks;
+	int count, kbytes, i, pid, status;
+	char *sbrk();
+
+	count = 100;
+	kbytes = 16;
+	while(argc > 1 && argv[1][0] == '-') {
+		switch(argv[1][1]) {
+		case 'v':
+			vflg++;
+			break;
+		case 'k':
+			if(argc < 3)
+				usage();
+			kbytes = atoi(argv[2]);
+			argc--;
+			argv++;
+			break;
+		default:
+			usage();
+		}
+		argc--;
+		argv++;
+	}
+	if(argc > 1)
+		count = atoi(argv[1]);
+	if(argc > 2)
+		cmd = argv[2];
+	if(count <= 0 || kbytes < 0)
+		usage();
+	if(sbrk(kbytes*1024) == (char *)-1) {
+		fprintf(stderr, "spawnbench: cannot grow to %dK\n", kbytes);
+		exit(1);
+	}
+	time(&t0);
+	for(i = 0; i < count; i++) {
+		pid = vflg? vfork(): fork();
+		if(pid == -1) {
+			fprintf(stderr, "spawnbench: cannot fork\n");
+			exit(1);
+		}
+		if(pid == 0) {
+			close(1);
+			open("/dev/null", 1);
+			execl(cmd, cmd, 0);
+			_exit(1);
+		}
+		while(wait(&status) != pid)
+			;
+		if(status != 0) {
+			fprintf(stderr, "spawnbench: %s failed\n", cmd);
+			exit(1);
+		}
+	}
+	time(&t1);
+	times(&tb);
+	t1 -= t0;
+	printf("%d launches of %s by %s, %dK of data\n",
+		count, cmd, vflg? "vfork": "fork", kbytes);
+	printf("real %D s", t1);
+	if(t1 > 0)
+		printf(", %D launches/s", (long)count/t1);
+	printf("\n");
+	ticks = tb.tms_stime;
+	printf("parent sys %D.%02D s", ticks/HZ, ticks%HZ*100/HZ);
+	ticks = tb.tms_cstime;
+	printf(", children sys %D.%02D s\n", ticks/HZ, ticks%HZ*100/HZ);
+	exit(0);
+}
+
+usage()
+{
+	fprintf(stderr, "usage: spawnbench [ -v ] [ -k kbytes ] [ count [ command ] ]\n");
+	exit(1);
+}
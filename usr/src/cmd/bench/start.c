@@ -0,0 +1,112 @@
+/*
+ * startbench - program startup latency
+ * usage: startbench [ count [ command ... ] ]
+ * Runs each command count times (default 20)
+ * with no arguments and its input and output on
+ * /dev/null, so that it does little more than
+ * start up and exit, and prints the time taken
+ * per run.  The default commands are the large
+ * standard ones.  After the first run a pure
+ * program's text is kept for the next, so most
+ * of the time is in setting up the process and
+ * reading its data; pstat -t shows how much
+ * was read straight to core.
+ */
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/times.h>
+
+#define	HZ	60
+
+char	*dflt[] = {
+	"/bin/cat",
+	"/bin/ed",
+	"/bin/sort",
+	"/bin/cc",
+	"/lib/c0",
+	"/lib/c1",
+	"/bin/troff",
+	"/bin/f77",
+	0
+};
+
+main(argc, argv)
+char **argv;
+{
+	struct tms tb;
+	time_t t0, t1;
+	long ticks, tticks, treal, n;
+	int count;
+	char **cp;
+
+	count = 20;
+	if(argc > 1)
+		count = atoi(argv[1]);
+	if(count <= 0)
+		usage();
+	cp = argc > 2? &argv[2]: dflt;
+	treal = 0;
+	tticks = 0;
+	n = 0;
+	printf("%d runs of each\n", count);
+	for(; *cp; cp++) {
+		if(access(*cp, 1) < 0) {
+			printf("%-16s cannot execute\n", *cp);
+			continue;
+		}
+		times(&tb);
+		ticks = tb.tms_cutime + tb.tms_cstime;
+		time(&t0);
+		run(*cp, count);
+		time(&t1);
+		times(&tb);
+		ticks = tb.tms_cutime + tb.tms_cstime - ticks;
+		t1 -= t0;
+		printf("%-16s real %D ms, user+sys %D ms per run\n", *cp,
+		    t1*1000/count, ticks*1000/HZ/count);
+		treal += t1;
+		tticks += ticks;
+		n += count;
+	}
+	if(n == 0)
+		exit(1);
+	printf("%-16s real %D ms, user+sys %D ms per run\n", "all",
+	    treal*1000/n, tticks*1000/HZ/n);
+	exit(0);
+}
+
+/*
+ * Run cmd count times, one after the other,
+ * as the shell would.
+ */
+run(cmd, count)
+char *cmd;
+{
+	int i, pid, status;
+
+	for(i = 0; i < count; i++) {
+		pid = fork();
+		if(pid == -1) {
+			fprintf(stderr, "startbench: cannot fork\n");
+			exit(1);
+		}
+		if(pid == 0) {
+			close(0);
+			open("/dev/null", 0);
+			close(1);
+			open("/dev/null", 1);
+			close(2);
+			dup(1);
+			execl(cmd, cmd, 0);
+			_exit(1);
+		}
+		while(wait(&status) != pid)
+			;
+	}
+}
+
+usage()
+{
+	fprintf(stderr, "usage: startbench [ count [ command ... ] ]\n");
+	exit(1);
+}
@@ -0,0 +1,113 @@
+/*
+ * switchbench - context switch latency
+ * usage: switchbench [ -l load ] [ count ]
+ * Two processes pass a byte back and forth count
+ * times (default 10000) through a pair of pipes,
+ * so that every transfer is a switch from one to
+ * the other.  With -l, load processes that only
+ * compute are started first, niced so that they
+ * stay runnable at a worse priority and lengthen
+ * the run queue the scheduler must search.
+ */
+#include <stdio.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/times.h>
+
+#define	MAXLOAD	40
+#define	HZ	60
+
+int	load;
+int	lpid[MAXLOAD];
+
+main(argc, argv)
+char **argv;
+{
+	struct tms tb;
+	time_t t0, t1;
+	long count, i, ticks;
+	int p1[2], p2[2], pid, status, j;
+	char c;
+
+	count = 10000;
+	while(argc > 1 && argv[1][0] == '-') {
+		if(argv[1][1] != 'l' || argc < 3)
+			usage();
+		load = atoi(argv[2]);
+		argc -= 2;
+		argv += 2;
+	}
+	if(argc > 1)
+		count = atol(argv[1]);
+	if(count <= 0 || load < 0 || load > MAXLOAD)
+		usage();
+	for(j = 0; j < load; j++) {
+		if((lpid[j] = fork()) == 0) {
+			nice(20);
+			for(;;)
+				;
+		}
+		if(lpid[j] == -1) {
+			fprintf(stderr, "switchbench: cannot fork\n");
+			done(1);
+		}
+	}
+	if(pipe(p1) < 0 || pipe(p2) < 0) {
+		fprintf(stderr, "switchbench: cannot make pipes\n");
+		done(1);
+	}
+	time(&t0);
+	pid = fork();
+	if(pid == -1) {
+		fprintf(stderr, "switchbench: cannot fork\n");
+		done(1);
+	}
+	if(pid == 0) {
+		for(i = 0; i < count; i++) {
+			if(read(p1[0], &c, 1) != 1)
+				exit(1);
+			write(p2[1], &c, 1);
+		}
+		exit(0);
+	}
+	c = 'x';
+	for(i = 0; i < count; i++) {
+		write(p1[1], &c, 1);
+		if(read(p2[0], &c, 1) != 1) {
+			fprintf(stderr, "switchbench: partner died\n");
+			done(1);
+		}
+	}
+	while(wait(&status) != pid)
+		;
+	time(&t1);
+	times(&tb);
+	t1 -= t0;
+	printf("%D round trips, %d load processes\n", count, load);
+	printf("real %D s", t1);
+	if(t1 > 0)
+		printf(", %D switches/s", 2*count/t1);
+	printf("\n");
+	ticks = tb.tms_stime + tb.tms_cstime;
+	printf("sys %D.%02D s", ticks/HZ, ticks%HZ*100/HZ);
+	if(ticks > 0)
+		printf(", %D us/switch", ticks*(1000000/HZ)/(2*count));
+	printf("\n");
+	done(0);
+}
+
+done(n)
+{
+	register i;
+
+	for(i = 0; i < load; i++)
+		if(lpid[i] > 0)
+			kill(lpid[i], SIGKILL);
+	exit(n);
+}
+
+usage()
+{
+	fprintf(stderr, "usage: switchbench [ -l load ] [ count ]\n");
+	exit(1);
+}
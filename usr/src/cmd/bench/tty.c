@@ -0,0 +1,146 @@
+/*
+ * ttybench - terminal line throughput
+ * usage: ttybench [ -r ] [ -k kbytes ] tty [ looptty ]
+ * Writes kbytes (default 64) of printable lines to tty,
+ * in cooked mode or with -r in raw mode, and reports
+ * the characters sent per second and the system time
+ * taken per character.  If looptty, a line cabled
+ * back to tty, is named, a second process reads
+ * everything back from it in raw mode, so the
+ * receiving side is measured as well.
+ */
+#include <stdio.h>
+#include <sgtty.h>
+#include <sys/types.h>
+#include <sys/times.h>
+
+#define	HZ	60
+#define	LINE	64
+
+char	line[LINE];
+int	rflg;
+long	nbytes	= 64L*1024L;
+
+main(argc, argv)
+char **argv;
+{
+	struct tms tb;
+	struct sgttyb old, new, lold;
+	time_t t0, t1;
+	long ticks, n;
+	int fd, lfd, pid, status, i;
+
+	while(argc > 1 && argv[1][0] == '-') {
+		switch(argv[1][1]) {
+		case 'r':
+			rflg++;
+			break;
+		case 'k':
+			if(argc < 3)
+				usage();
+			nbytes = atol(argv[2]) * 1024L;
+			argc--;
+			argv++;
+			break;
+		default:
+			usage();
+		}
+		argc--;
+		argv++;
+	}
+	if(argc < 2 || argc > 3 || nbytes <= 0)
+		usage();
+	for(i = 0; i < LINE-1; i++)
+		line[i] = ' ' + i%64;
+	line[LINE-1] = '\n';
+	if((fd = open(argv[1], 1)) < 0 || gtty(fd, &old) < 0) {
+		fprintf(stderr, "ttybench: cannot use %s\n", argv[1]);
+		exit(1);
+	}
+	new = old;
+	new.sg_flags &= ~(ECHO|CRMOD|RAW|NLDELAY|TBDELAY|CRDELAY|VTDELAY);
+	if(rflg)
+		new.sg_flags |= RAW;
+	stty(fd, &new);
+	pid = 0;
+	if(argc > 2) {
+		if((lfd = open(argv[2], 0)) < 0 || gtty(lfd, &lold) < 0) {
+			fprintf(stderr, "ttybench: cannot use %s\n", argv[2]);
+			done(fd, &old, 1);
+		}
+		new.sg_flags |= RAW;
+		new.sg_flags &= ~ECHO;
+		stty(lfd, &new);
+		pid = fork();
+		if(pid == -1) {
+			fprintf(stderr, "ttybench: cannot fork\n");
+			done(fd, &old, 1);
+		}
+		if(pid == 0) {
+			reader(lfd);
+			stty(lfd, &lold);
+			exit(0);
+		}
+		close(lfd);
+	}
+	time(&t0);
+	for(n = nbytes; n > 0; n -= i) {
+		i = n < LINE? n: LINE;
+		if(write(fd, line+LINE-i, i) != i) {
+			fprintf(stderr, "ttybench: write error\n");
+			done(fd, &old, 1);
+		}
+	}
+	if(pid) {
+		while(wait(&status) != pid)
+			;
+		if(status != 0)
+			done(fd, &old, 1);
+	} else
+		stty(fd, &old);		/* waits for output to drain */
+	time(&t1);
+	times(&tb);
+	t1 -= t0;
+	printf("%D bytes %s%s\n", nbytes, rflg? "raw": "cooked",
+		pid? ", looped back": "");
+	printf("real %D s", t1);
+	if(t1 > 0)
+		printf(", %D chars/s", nbytes/t1);
+	printf("\n");
+	ticks = tb.tms_stime + tb.tms_cstime;
+	printf("sys %D.%02D s", ticks/HZ, ticks%HZ*100/HZ);
+	if(ticks > 0)
+		printf(", %D us/char", ticks*(1000000/HZ)/nbytes);
+	printf("\n");
+	done(fd, &old, 0);
+}
+
+/*
+ * Read back everything sent.
+ */
+reader(fd)
+{
+	char buf[512];
+	long n;
+	int c;
+
+	for(n = 0; n < nbytes; n += c)
+		if((c = read(fd, buf, sizeof buf)) <= 0) {
+			fprintf(stderr, "ttybench: read %D bytes\n", n);
+			exit(1);
+		}
+}
+
+done(fd, sp, n)
+struct sgttyb *sp;
+{
+
+	stty(fd, sp);
+	exit(n);
+}
+
+usage()
+{
+	fprintf(stderr, "usage: ttybench [ -r ] [ -k kbytes ] tty [ looptty ]\n");
+	exit(1);
+}
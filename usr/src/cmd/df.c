@@ -16,6 +16,7 @@ struct	filsys sblock;
 
 int	fi;
 daddr_t	alloc();
+daddr_t	bmcount();
 
 main(argc, argv)
 char **argv;
@@ -45,8 +46,11 @@ char *file;
 	sync();
 	bread(1L, (char *)&sblock, sizeof(sblock));
 	i = 0;
-	while(alloc())
-		i++;
+	if(sblock.s_flags & FS_BITMAP)
+		i = bmcount();
+	else
+		while(alloc())
+			i++;
 	printf("%s %D\n", file, i);
 	close(fi);
 }
@@ -80,6 +84,28 @@ alloc()
 	return(b);
 }
 
+/*
+ * Count the bits set in the
+ * free-block bitmap.
+ */
+daddr_t
+bmcount()
+{
+	char map[BSIZE];
+	daddr_t d, n;
+	register i;
+
+	n = 0;
+	for(d=0; d<sblock.s_fsize; d++) {
+		i = (int)d & BMMASK;
+		if(i == 0)
+			bread(sblock.s_bmap + (d>>BMSHIFT), map, BSIZE);
+		if(map[i>>3] & (1<<(i&07)))
+			n++;
+	}
+	return(n);
+}
+
 bread(bno, buf, cnt)
 daddr_t bno;
 char *buf;
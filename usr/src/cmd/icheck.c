@@ -36,6 +36,11 @@ daddr_t	niiindir;
 daddr_t	nfree;
 daddr_t	ndup;
 
+char	imbuf[BSIZE];
+daddr_t	imblk	= -1;
+ino_t	nimfree;
+ino_t	nimbad;
+
 int	nerror;
 
 long	atol();
@@ -124,6 +129,8 @@ char *file;
 	niiindir = 0;
 
 	ndup = 0;
+	nimfree = 0;
+	nimbad = 0;
 #ifndef STANDALONE
 	sync();
 #endif
@@ -157,8 +164,12 @@ char *file;
 				break;
 			ino++;
 			pass1(&itab[j]);
+			if (sblock.s_flags & FS_IMAP)
+				imark(&itab[j]);
 		}
 	}
+	if (sblock.s_flags & FS_IMAP)
+		imflush();
 	ino = 0;
 #ifndef STANDALONE
 	sync();
@@ -174,10 +185,20 @@ char *file;
 		return;
 	}
 	nfree = 0;
-	while(n = alloc()) {
-		if (chk(n, "free"))
-			break;
-		nfree++;
+	if (sblock.s_flags & FS_BITMAP)
+		bmcheck();
+	else
+		while(n = alloc()) {
+			if (chk(n, "free"))
+				break;
+			nfree++;
+		}
+	if (sblock.s_flags & FS_IMAP) {
+		if (nimbad)
+			printf("%u wrong in inode map\n", nimbad);
+		if (nimfree != sblock.s_tinode)
+			printf("free inode count %u in super-block\n",
+				sblock.s_tinode);
 	}
 	close(fi);
 #ifndef STANDALONE
@@ -205,7 +226,7 @@ char *file;
 #endif
 	if(!dflg) {
 		n = 0;
-		for(d=sblock.s_isize; d<sblock.s_fsize; d++)
+		for(d=FSDATA(&sblock); d<sblock.s_fsize; d++)
 			if(!duped(d)) {
 				if(mflg)
 					printf("%ld missing\n", d);
@@ -298,7 +319,7 @@ char *s;
 {
 	register n;
 
-	if (bno<sblock.s_isize || bno>=sblock.s_fsize) {
+	if (bno<FSDATA(&sblock) || bno>=sblock.s_fsize) {
 		printf("%ld bad; inode=%u, class=%s\n", bno, ino, s);
 		return(1);
 	}
@@ -365,6 +386,97 @@ alloc()
 	return(bno);
 }
 
+/*
+ * Check the free-block bitmap
+ * as alloc checks the free list.
+ */
+bmcheck()
+{
+	char map[BSIZE];
+	daddr_t d;
+	register i;
+
+	for(d=0; d<sblock.s_fsize; d++) {
+		i = (int)d & BMMASK;
+		if(i == 0)
+			bread(sblock.s_bmap + (d>>BMSHIFT), map, BSIZE);
+		if(map[i>>3] & (1<<(i&07)))
+			if(chk(d, "free") == 0)
+				nfree++;
+	}
+	if(nfree != sblock.s_tfree)
+		printf("free count %ld in super-block\n", sblock.s_tfree);
+}
+
+/*
+ * Rebuild the bitmap from the
+ * blocks not found in any file.
+ */
+bmmake()
+{
+	char map[BSIZE];
+	daddr_t d, f;
+	register i;
+
+	for(d=0; d<sblock.s_nbmap; d++) {
+		for(i=0; i<BSIZE; i++)
+			map[i] = 0;
+		for(i=0; i<BSIZE*8; i++) {
+			f = (d<<BMSHIFT) + i;
+			if(f >= BMDATA(&sblock) && f < sblock.s_fsize)
+				if(!duped(f)) {
+					map[i>>3] |= 1<<(i&07);
+					sblock.s_tfree++;
+				}
+		}
+		bwrite(sblock.s_bmap+d, map);
+	}
+	sblock.s_brotor = BMDATA(&sblock);
+}
+
+/*
+ * Note in imbuf whether the inode ino is
+ * free, a block of the inode map at a time;
+ * each block is then rewritten, with -s, or
+ * compared with the map on the disk.
+ */
+imark(ip)
+struct dinode *ip;
+{
+	register i;
+
+	if ((ino>>BMSHIFT) != imblk) {
+		imflush();
+		imblk = ino>>BMSHIFT;
+	}
+	i = ino & BMMASK;
+	if ((ip->di_mode&IFMT) == 0 && ino >= ROOTINO) {
+		imbuf[i>>3] |= 1<<(i&07);
+		nimfree++;
+	}
+}
+
+imflush()
+{
+	char map[BSIZE];
+	register i, c;
+
+	if (imblk < 0)
+		return;
+	if (sflg)
+		bwrite(sblock.s_imap+imblk, imbuf);
+	else {
+		bread(sblock.s_imap+imblk, map, BSIZE);
+		for(i=0; i<BSIZE; i++)
+			for(c = (map[i]^imbuf[i]) & 0377; c; c >>= 1)
+				if (c & 01)
+					nimbad++;
+	}
+	for(i=0; i<BSIZE; i++)
+		imbuf[i] = 0;
+	imblk = -1;
+}
+
 bfree(bno)
 daddr_t bno;
 {
@@ -456,16 +568,24 @@ makefree()
 	sblock.s_tfree = 0;
 	sblock.s_tinode = 0;
 
-	bfree((daddr_t)0);
-	d = sblock.s_fsize-1;
-	while(d%sblock.s_n)
-		d++;
-	for(; d > 0; d -= sblock.s_n)
-	for(i=0; i<sblock.s_n; i++) {
-		f = d - adr[i];
-		if(f < sblock.s_fsize && f >= sblock.s_isize)
-			if(!duped(f))
-				bfree(f);
+	if (sblock.s_flags & FS_BITMAP)
+		bmmake();
+	else {
+		bfree((daddr_t)0);
+		d = sblock.s_fsize-1;
+		while(d%sblock.s_n)
+			d++;
+		for(; d > 0; d -= sblock.s_n)
+		for(i=0; i<sblock.s_n; i++) {
+			f = d - adr[i];
+			if(f < sblock.s_fsize && f >= FSDATA(&sblock))
+				if(!duped(f))
+					bfree(f);
+		}
+	}
+	if (sblock.s_flags & FS_IMAP) {
+		sblock.s_tinode = nimfree;
+		sblock.s_irotor = ROOTINO;
 	}
 	bwrite((daddr_t)1, (char *)&sblock);
 #ifndef STANDALONE
@@ -4,6 +4,8 @@ int	tflg;
 int	iflg;
 int	aflg;
 int	sflg;
+int	qflg;
+int	wflg;
 struct
 {
 	char	name[8];
@@ -12,6 +14,14 @@ struct
 } nl[] = {
 	"_dk_busy", 0, 0,
 	"_io_info", 0, 0,
+	"_dk_qlen", 0, 0,
+	"_dk_seek", 0, 0,
+	"_dk_wait", 0, 0,
+	"_dk_nrd", 0, 0,
+	"_sw_info", 0, 0,
+	"_bm_info", 0, 0,
+	"_ia_info", 0, 0,
+	"_up_info", 0, 0,
 	"\0\0\0\0\0\0\0\0", 0, 0
 };
 struct
@@ -30,8 +40,35 @@ struct iostat {
 	long	nreada;
 	long	ncache;
 	long	nwrite;
+	long	nhlook;
+	long	nhprobe;
+	int	nhmax;
+	long	nhchain[8];
+	long	nrahit;
+	long	nrawaste;
+	long	nwbehind;
+	long	nwtrick;
+	long	ndwage[8];
 	long	bufcount[50];
 } io_info, io_delta;
+struct {
+	long	nind;
+	long	nhit;
+	long	nsaved;
+} bm, bm1;
+struct {
+	long	nalloc;
+	long	nscan;
+	long	nblk;
+	long	nexam;
+} ia, ia1;
+struct {
+	long	nsync;
+	long	ninode;
+	long	nbuf;
+	long	nticks;
+	long	maxticks;
+} up, up1;
 double	etime;
 
 int	mf;
@@ -69,6 +106,10 @@ char *argv[];
 			iflg++;
 		else if (argv[1][1]=='b')
 			bflg++;
+		else if (argv[1][1]=='q')
+			qflg++;
+		else if (argv[1][1]=='w')
+			wflg++;
 		argc--;
 		argv++;
 	}
@@ -103,6 +144,14 @@ loop:
 		biostats();
 		goto contin;
 	}
+	if (qflg) {
+		qstats();
+		goto contin;
+	}
+	if (wflg) {
+		wstats();
+		goto contin;
+	}
 	if (dflg) {
 		long tm;
 		time(&tm);
@@ -251,9 +300,80 @@ double t;
 	printf("%6.2f RP active\n", sum/t);
 }
 
+/*
+ * Per-drive queue depth, seek distance and
+ * time from queueing to completion, averaged
+ * over the requests in the interval.
+ */
+long	qlen[3], qlen1[3];
+long	seek[3], seek1[3];
+long	dwait[3], dwait1[3];
+long	nrd[3], nrd1[3];
+long	numb1[3];
+
+qstats()
+{
+	register i;
+	long t;
+	double n;
+	static char *dname[] = { "RF", "RK", "RP" };
+
+	lseek(mf, (long)nl[2].value, 0);
+	read(mf, (char *)qlen, sizeof qlen);
+	lseek(mf, (long)nl[3].value, 0);
+	read(mf, (char *)seek, sizeof seek);
+	lseek(mf, (long)nl[4].value, 0);
+	read(mf, (char *)dwait, sizeof dwait);
+	lseek(mf, (long)nl[5].value, 0);
+	read(mf, (char *)nrd, sizeof nrd);
+	printf("      reqs reads  qlen  seek  msrq\n");
+	for(i=0; i<3; i++) {
+		t = s.numb[i];
+		n = t - numb1[i];
+		numb1[i] = t;
+		printf("%s%8.0f%6D", dname[i], n, nrd[i]-nrd1[i]);
+		if (n == 0.)
+			n = 1.;
+		printf("%6.1f", (qlen[i]-qlen1[i])/n);
+		printf("%6.1f", (seek[i]-seek1[i])/n);
+		printf("%6.0f\n", (dwait[i]-dwait1[i])*1000./(60.*n));
+		qlen1[i] = qlen[i];
+		seek1[i] = seek[i];
+		dwait1[i] = dwait[i];
+		nrd1[i] = nrd[i];
+	}
+}
+
+/*
+ * Swap transfers and kilobytes
+ * per second, in and out.
+ */
+struct swinfo {
+	long	nswin;
+	long	nswout;
+	long	swinclk;
+	long	swoutclk;
+} sw, sw1;
+
+wstats()
+{
+	double t;
+
+	lseek(mf, (long)nl[6].value, 0);
+	read(mf, (char *)&sw, sizeof sw);
+	t = etime/60.;
+	printf("  in/s  KB/s out/s  KB/s\n");
+	printf("%6.1f", (sw.nswin-sw1.nswin)/t);
+	printf("%6.1f", (sw.swinclk-sw1.swinclk)/(16.*t));
+	printf("%6.1f", (sw.nswout-sw1.nswout)/t);
+	printf("%6.1f\n", (sw.swoutclk-sw1.swoutclk)/(16.*t));
+	sw1 = sw;
+}
+
 biostats()
 {
 register i;
+double f;
 
 	lseek(mf,(long)nl[1].value, 0);
 	read(mf, (char *)&io_info, sizeof(io_info));
@@ -267,5 +387,48 @@ register i;
 		if (i % 10 == 0)
 			printf("\n");
 	}
+	f = io_info.nhlook-io_delta.nhlook;
+	if (f == 0.)
+		f = 1.;
+	printf("hash: %D lookups %.2f avg chain %d max\n",
+	 io_info.nhlook-io_delta.nhlook,
+	 (io_info.nhprobe-io_delta.nhprobe)/f, io_info.nhmax);
+	for(i=0; i<8; i++)
+		printf("%D\t", io_info.nhchain[i]-io_delta.nhchain[i]);
+	printf("\n");
+	printf("read-ahead: %D hit %D wasted\n",
+	 io_info.nrahit-io_delta.nrahit, io_info.nrawaste-io_delta.nrawaste);
+	printf("delayed writes: %D write-behind %D flushed by age\n",
+	 io_info.nwbehind-io_delta.nwbehind, io_info.nwtrick-io_delta.nwtrick);
+	printf("age(s)\t0\t1\t2\t4\t8\t16\t32\t64\n\t");
+	for(i=0; i<8; i++)
+		printf("%D\t", io_info.ndwage[i]-io_delta.ndwage[i]);
+	printf("\n");
 	io_delta = io_info;
+	if(nl[7].type == -1)
+		return;
+	lseek(mf, (long)nl[7].value, 0);
+	read(mf, (char *)&bm, sizeof(bm));
+	printf("bmap: %D indirect %D from map cache %D indirect reads saved\n",
+	 bm.nind-bm1.nind, bm.nhit-bm1.nhit, bm.nsaved-bm1.nsaved);
+	bm1 = bm;
+	if(nl[8].type == -1)
+		return;
+	lseek(mf, (long)nl[8].value, 0);
+	read(mf, (char *)&ia, sizeof(ia));
+	printf("ialloc: %D inodes %D scans %D blocks read %D inodes examined\n",
+	 ia.nalloc-ia1.nalloc, ia.nscan-ia1.nscan, ia.nblk-ia1.nblk,
+	 ia.nexam-ia1.nexam);
+	ia1 = ia;
+	if(nl[9].type == -1)
+		return;
+	lseek(mf, (long)nl[9].value, 0);
+	read(mf, (char *)&up, sizeof(up));
+	f = up.nsync-up1.nsync;
+	if (f == 0.)
+		f = 1.;
+	printf("sync: %D calls %D inodes %D buffers %.0f ms avg %.0f ms max\n",
+	 up.nsync-up1.nsync, up.ninode-up1.ninode, up.nbuf-up1.nbuf,
+	 (up.nticks-up1.nticks)*1000./(60.*f), up.maxticks*1000./60.);
+	up1 = up;
 }
@@ -1,6 +1,8 @@
 /*
  * Make a file system prototype.
- * usage: mkfs filsys proto/size [ m n ]
+ * usage: mkfs [ -b ] [ -i ] filsys proto/size [ m n ]
+ * -b keeps free blocks in a bitmap instead of a free list.
+ * -i keeps a bitmap of free inodes as well.
  */
 #define	NIPB	(BSIZE/sizeof(struct dinode))
 #define	NINDIR	(BSIZE/sizeof(daddr_t))
@@ -44,10 +46,13 @@ char	*fsys;
 char	*proto;
 int	f_n	= MAXFN;
 int	f_m	= 3;
+int	bflg;
+int	iflg;
 int	error;
 ino_t	ino;
 long	getnum();
 daddr_t	alloc();
+daddr_t	bmalloc();
 
 main(argc, argv)
 char *argv[];
@@ -57,8 +62,18 @@ char *argv[];
 
 #ifndef STANDALONE
 	time(&utime);
+	while(argc > 1 && argv[1][0] == '-') {
+		if(argv[1][1] == 'b')
+			bflg++;
+		else if(argv[1][1] == 'i')
+			iflg++;
+		else
+			argc = 0;
+		argc--;
+		argv++;
+	}
 	if(argc < 3) {
-		printf("usage: mkfs filsys proto/size [ m n ]\n");
+		printf("usage: mkfs [ -b ] [ -i ] filsys proto/size [ m n ]\n");
 		exit(1);
 	}
 	fsys = argv[1];
@@ -175,6 +190,28 @@ f3:
 		printf("%ld/%ld: bad ratio\n", filsys.s_fsize, filsys.s_isize-2);
 		exit(1);
 	}
+	if(iflg) {
+		filsys.s_flags |= FS_IMAP;
+		filsys.s_imap = filsys.s_isize;
+		filsys.s_nimap = (((filsys.s_isize-2)*NIPB) >> BMSHIFT) + 1;
+		filsys.s_irotor = ROOTINO;
+		if(IMDATA(&filsys.fs) >= filsys.s_fsize) {
+			printf("no room for inode map\n");
+			exit(1);
+		}
+		printf("inode map = %d\n", filsys.s_nimap);
+	}
+	if(bflg) {
+		filsys.s_flags |= FS_BITMAP;
+		filsys.s_bmap = filsys.s_isize + filsys.s_nimap;
+		filsys.s_nbmap = (filsys.s_fsize + BMMASK) >> BMSHIFT;
+		filsys.s_brotor = filsys.s_bmap + filsys.s_nbmap;
+		if(filsys.s_brotor >= filsys.s_fsize) {
+			printf("no room for bitmap\n");
+			exit(1);
+		}
+		printf("bitmap = %d\n", filsys.s_nbmap);
+	}
 	filsys.s_tfree = 0;
 	filsys.s_tinode = 0;
 	for(c=0; c<BSIZE; c++)
@@ -188,6 +225,8 @@ f3:
 	bflist();
 
 	cfile((struct inode *)0);
+	if(iflg)
+		imlist();
 
 	filsys.s_time = utime;
 	wtfs((long)1, (char *)&filsys);
@@ -403,6 +442,8 @@ alloc()
 	int i;
 	daddr_t bno;
 
+	if(bflg)
+		return(bmalloc());
 	filsys.s_tfree--;
 	bno = filsys.s_free[--filsys.s_nfree];
 	if(bno == 0) {
@@ -434,6 +475,94 @@ daddr_t bno;
 	filsys.s_free[filsys.s_nfree++] = bno;
 }
 
+/*
+ * Take the next free block in the bitmap.
+ * Files are laid down one after another
+ * from the rotor.
+ */
+daddr_t
+bmalloc()
+{
+	char map[BSIZE];
+	daddr_t bno, mb;
+	int i;
+
+	mb = 0;
+	for(bno = filsys.s_brotor; bno < filsys.s_fsize; bno++) {
+		if(mb != filsys.s_bmap + (bno>>BMSHIFT)) {
+			mb = filsys.s_bmap + (bno>>BMSHIFT);
+			rdfs(mb, map);
+		}
+		i = (int)bno & BMMASK;
+		if(map[i>>3] & (1<<(i&07))) {
+			map[i>>3] &= ~(1<<(i&07));
+			wtfs(mb, map);
+			filsys.s_tfree--;
+			filsys.s_brotor = bno+1;
+			return(bno);
+		}
+	}
+	printf("out of free space\n");
+	exit(1);
+}
+
+/*
+ * Write the bitmap: every block after it is
+ * free but for bad ones, which go into ib
+ * for the bad block file.
+ */
+bmlist(ib, aibc)
+daddr_t *ib;
+int *aibc;
+{
+	daddr_t d, f;
+	int i;
+
+	for(d=0; d<filsys.s_nbmap; d++) {
+		for(i=0; i<BSIZE; i++)
+			buf[i] = 0;
+		for(i=0; i<BSIZE*8; i++) {
+			f = (d<<BMSHIFT) + i;
+			if(f < filsys.s_brotor || f >= filsys.s_fsize)
+				continue;
+			if(badblk(f)) {
+				if(*aibc >= NINDIR) {
+					printf("too many bad blocks\n");
+					error = 1;
+					*aibc = 0;
+				}
+				ib[(*aibc)++] = f;
+			} else {
+				buf[i>>3] |= 1<<(i&07);
+				filsys.s_tfree++;
+			}
+		}
+		wtfs(filsys.s_bmap+d, buf);
+	}
+}
+
+/*
+ * Write the inode map: the inodes
+ * after the last one made are free.
+ */
+imlist()
+{
+	daddr_t d;
+	unsigned i, f, mino;
+
+	mino = (filsys.s_isize-2) * NIPB;
+	for(d=0; d<filsys.s_nimap; d++) {
+		for(i=0; i<BSIZE; i++)
+			buf[i] = 0;
+		for(i=0; i<BSIZE*8; i++) {
+			f = ((unsigned)d<<BMSHIFT) + i;
+			if(f > ino && f <= mino)
+				buf[i>>3] |= 1<<(i&07);
+		}
+		wtfs(filsys.s_imap+d, buf);
+	}
+}
+
 entry(inum, str, adbc, db, aibc, ib)
 ino_t inum;
 char *str;
@@ -525,6 +654,11 @@ bflist()
 	for(i=0; i<NINDIR; i++)
 		ib[i] = (daddr_t)0;
 	ibc = 0;
+	if(bflg) {
+		bmlist(ib, &ibc);
+		iput(&in, &ibc, ib);
+		return;
+	}
 	bfree((daddr_t)0);
 	d = filsys.s_fsize-1;
 	while(d%f_n)
@@ -532,7 +666,7 @@ bflist()
 	for(; d > 0; d -= f_n)
 	for(i=0; i<f_n; i++) {
 		f = d - adr[i];
-		if(f < filsys.s_fsize && f >= filsys.s_isize)
+		if(f < filsys.s_fsize && f >= FSDATA(&filsys.fs))
 			if(badblk(f)) {
 				if(ibc >= NINDIR) {
 					printf("too many bad blocks\n");
@@ -28,6 +28,7 @@ int	lflg;
 int	vflg;
 int	kflg;
 int	xflg;
+int	iflg;
 char	*tptr;
 long	lseek();
 char	*gettty();
@@ -89,6 +90,10 @@ char **argv;
 			kflg++;
 			break;
 
+		case 'i':
+			iflg++;
+			break;
+
 		default:
 			chkpid = atoi(ap-1);
 			goto bbreak;
@@ -131,8 +136,13 @@ bbreak:
 	getdev();
 	uid = getuid();
 	if (lflg)
-	printf(" F S UID   PID  PPID CPU PRI NICE  ADDR  SZ  WCHAN TTY TIME CMD\n"); else
-		if (chkpid==0) printf("   PID TTY TIME CMD\n");
+	printf(" F S UID   PID  PPID CPU PRI NICE  ADDR  SZ  WCHAN TTY TIME"); else
+		if (chkpid==0) printf("   PID TTY TIME");
+	if (lflg || chkpid==0) {
+		if (iflg)
+			printf("  RBLK  WBLK   HIT  WAIT");
+		printf(" CMD\n");
+	}
 	for (i=0; i<NPROC; i++) {
 		read(mem, (char *)&mproc, sizeof mproc);
 		if (mproc.p_stat==0)
@@ -270,6 +280,11 @@ prcom(puid)
 		tm %= 60;
 		printf(tm<10?"0%ld":"%ld", tm);
 	}
+	if (iflg) {
+		/* blocks read, written, found in cache; seconds waited */
+		printf("%6ld%6ld%6ld", u.u_ior, u.u_iow, u.u_iohit);
+		printf("%6ld", (u.u_iowt + 30)/60);
+	}
 	if (mproc.p_pid == 0) {
 		printf(" swapper");
 		return(1);
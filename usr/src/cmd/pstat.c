@@ -6,6 +6,7 @@
 #include <sys/param.h>
 #include <sys/conf.h>
 #include <sys/tty.h>
+#include <sys/map.h>
 
 char	*fcore	= "/dev/mem";
 char	*fnlist	= "/unix";
@@ -30,6 +31,18 @@ struct setup {
 	"_kl11", 0, 0,
 #define	SFIL	6
 	"_file", 0, 0,
+#define	SNCH	7
+	"_nchstat", 0, 0,
+#define	SXST	8
+	"_xstats", 0, 0,
+#define	SCMAP	9
+	"_coremap", 0, 0,
+#define	SSMAP	10
+	"_swapmap", 0, 0,
+#define	SMST	11
+	"_mapstat", 0, 0,
+#define	SFST	12
+	"_fstats", 0, 0,
 	0,
 };
 
@@ -40,6 +53,8 @@ int	ttyf;
 int	usrf;
 long	ubase;
 int	filf;
+int	nchf;
+int	mapf;
 int	allflg;
 
 main(argc, argv)
@@ -79,6 +94,14 @@ char **argv;
 		case 'f':
 			filf++;
 			break;
+
+		case 'n':
+			nchf++;
+			break;
+
+		case 'm':
+			mapf++;
+			break;
 		}
 	}
 	if (argc>0)
@@ -106,6 +129,10 @@ char **argv;
 		dousr();
 	if (filf)
 		dofil();
+	if (nchf)
+		donch();
+	if (mapf)
+		domap();
 }
 
 doinode()
@@ -161,8 +188,10 @@ dotext()
 #include <sys/text.h>
 	register struct text *xp;
 	struct text xtext[NTEXT];
+	struct xstats xs;
 	register loc;
 	int ntx;
+	long tot;
 
 	ntx = 0;
 	lseek(fc, (long)setup[STEXT].value, 0);
@@ -171,7 +200,7 @@ dotext()
 		if (xp->x_iptr!=NULL)
 			ntx++;
 	printf("%d text segments\n", ntx);
-	printf("   LOC FLAGS DADDR  CADDR SIZE   IPTR  CNT CCNT\n");
+	printf("   LOC  FLAGS DADDR  CADDR SIZE   IPTR  CNT CCNT\n");
 	loc = setup[STEXT].value;
 	for (xp = xtext; xp < &xtext[NTEXT]; xp++, loc+=sizeof(xtext[0])) {
 		if (xp->x_iptr == NULL)
@@ -183,6 +212,7 @@ dotext()
 		putf(xp->x_flag&XLOAD, 'L');
 		putf(xp->x_flag&XLOCK, 'K');
 		putf(xp->x_flag&XWANT, 'w');
+		putf(xp->x_flag&XCACHE, 'C');
 		printf("%5u", xp->x_daddr);
 		printf("%7.1o", xp->x_caddr);
 		printf("%5d", xp->x_size);
@@ -191,6 +221,22 @@ dotext()
 		printf("%4d", xp->x_ccount);
 		printf("\n");
 	}
+	if (setup[SXST].type == -1)
+		return;
+	lseek(fc, (long)setup[SXST].value, 0);
+	read(fc, (char *)&xs, sizeof(xs));
+	tot = xs.xs_alloc;
+	printf("text cache: %D execs\n", tot);
+	if (tot == 0)
+		tot = 1;
+	printf("%D in use (%D%%), %D kept (%D%%, %D in core), %D read\n",
+	    xs.xs_hit, xs.xs_hit*100/tot,
+	    xs.xs_chit, xs.xs_chit*100/tot, xs.xs_ccore, xs.xs_miss);
+	printf("%D dropped, %D gave up core\n", xs.xs_evict, xs.xs_reclaim);
+	printf("%D blocks read straight to core in %D transfers\n",
+	    xs.xs_rawb, xs.xs_rawx);
+	printf("%D data pages left to first touch, %D read on a fault\n",
+	    xs.xs_dldef, xs.xs_dlflt);
 }
 
 doproc()
@@ -367,6 +413,7 @@ dofil()
 {
 #include <sys/file.h>
 	struct file xfile[NFILE];
+	struct fstats fs;
 	register struct file *fp;
 	register nf;
 	int loc;
@@ -390,4 +437,77 @@ dofil()
 		printf("%8.1o", fp->f_inode);
 		printf(" %ld\n", fp->f_un.f_offset);
 	}
+	if (setup[SFST].type == -1)
+		return;
+	lseek(fc, (long)setup[SFST].value, 0);
+	read(fc, (char *)&fs, sizeof(fs));
+	printf("file table: %d in use, %d most at once of %d\n",
+	    fs.fs_inuse, fs.fs_hiwat, NFILE);
+	printf("%D opened, %D failed\n", fs.fs_alloc, fs.fs_fail);
+}
+
+donch()
+{
+#include <sys/nch.h>
+	struct nchstats ns;
+	long tot;
+
+	if (setup[SNCH].type == -1) {
+		printf("no name cache\n");
+		return;
+	}
+	lseek(fc, (long)setup[SNCH].value, 0);
+	read(fc, (char *)&ns, sizeof(ns));
+	tot = ns.ncs_hits + ns.ncs_neghits + ns.ncs_miss;
+	printf("name cache: %D lookups\n", tot);
+	if (tot == 0)
+		tot = 1;
+	printf("%D hits (%D%%), %D negative hits (%D%%), %D misses\n",
+	    ns.ncs_hits, ns.ncs_hits*100/tot,
+	    ns.ncs_neghits, ns.ncs_neghits*100/tot, ns.ncs_miss);
+	printf("%D entered, %D purged\n", ns.ncs_enter, ns.ncs_purge);
+}
+
+domap()
+{
+
+	lseek(fc, (long)setup[SMST].value, 0);
+	read(fc, (char *)mapstat, sizeof(mapstat));
+	lseek(fc, (long)setup[SCMAP].value, 0);
+	read(fc, (char *)coremap, sizeof(coremap));
+	prmap("core", coremap, &mapstat[0], 64);
+	lseek(fc, (long)setup[SSMAP].value, 0);
+	read(fc, (char *)swapmap, sizeof(swapmap));
+	prmap("swap", swapmap, &mapstat[1], 512);
+}
+
+/*
+ * Free space in a map, and how badly it
+ * is broken up: the pieces, the largest, and
+ * the allocations that failed though enough
+ * was free in all.
+ */
+prmap(name, mp, sp, unit)
+char *name;
+struct map *mp;
+struct mapstat *sp;
+{
+	register struct map *bp;
+	long tot, big;
+	int n;
+
+	tot = big = 0;
+	n = 0;
+	for (bp = mp; bp->m_size; bp++) {
+		n++;
+		tot += (unsigned)bp->m_size;
+		if ((unsigned)bp->m_size > big)
+			big = (unsigned)bp->m_size;
+	}
+	printf("%s map: %D bytes free in %d pieces, largest %D\n",
+	    name, tot*unit, n, big*unit);
+	printf("%D allocated, %D failed (%D for want of a large piece)\n",
+	    sp->ms_alloc, sp->ms_fail, sp->ms_frag);
+	printf("%D freed, %D joined to a neighbor, %D units lost\n",
+	    sp->ms_free, sp->ms_merge, sp->ms_lost);
 }
@@ -23,6 +23,7 @@ int	thres	= 1;
 int	sflg;
 int	bflg;
 int	mflg;
+int	dflg;
 
 struct	user {
 	int	ncomm;
@@ -36,11 +37,13 @@ struct	tab {
 	float	realt;
 	float	cput;
 	float	syst;
+	float	iot;
 } tab[size];
 
 float	treal;
 float	tcpu;
 float	tsys;
+float	tio;
 int	junkp = -1;
 char	*sname;
 float	ncom;
@@ -131,6 +134,10 @@ char **argv;
 		case 'm':
 			mflg++;
 			break;
+
+		case 'd':
+			dflg++;
+			break;
 		}
 	}
 	if (iflg==0)
@@ -165,6 +172,7 @@ char **argv;
 		tab[junkp].realt += tab[i].realt;
 		tab[junkp].cput += tab[i].cput;
 		tab[junkp].syst += tab[i].syst;
+		tab[junkp].iot += tab[i].iot;
 		tab[i].name[0] = 0;
 	}
 	for(i=k=0; i<size; i++)
@@ -175,6 +183,7 @@ char **argv;
 		tab[k].realt = tab[i].realt;
 		tab[k].cput = tab[i].cput;
 		tab[k].syst = tab[i].syst;
+		tab[k].iot = tab[i].iot;
 		k++;
 	}
 	if (sflg) {
@@ -200,12 +209,12 @@ char **argv;
 		exit(0);
 	}
 	qsort(tab, k, sizeof(tab[0]), nflg? ncmp: (bflg?bcmp:tcmp));
-	column(ncom, treal, tcpu, tsys);
+	column(ncom, treal, tcpu, tsys, tio);
 	printf("\n");
 	for (i=0; i<k; i++)
 	if (tab[i].name[0]) {
 		ft = tab[i].count;
-		column(ft, tab[i].realt, tab[i].cput, tab[i].syst);
+		column(ft, tab[i].realt, tab[i].cput, tab[i].syst, tab[i].iot);
 		printf("   %.10s\n", tab[i].name);
 	}
 }
@@ -233,8 +242,8 @@ printmoney()
 	}
 }
 
-column(n, a, b, c)
-double n, a, b, c;
+column(n, a, b, c, d)
+double n, a, b, c, d;
 {
 
 	printf("%6.0f", n);
@@ -253,6 +262,11 @@ double n, a, b, c;
 		col(n, b+c, tcpu+tsys);
 	if(tflg)
 		printf("%6.1f", a/(b+c));
+	if(dflg) {
+		if(jflg)
+			printf("%8.1f", d/n); else
+			printf("%8.0f", d);
+	}
 }
 
 col(n, a, m)
@@ -327,6 +341,9 @@ char *f;
 		x = expand(fbuf.ac_stime);
 		tab[i].syst += x;
 		tsys += x;
+		x = expand(fbuf.ac_io);
+		tab[i].iot += x;
+		tio += x;
 	}
 	fclose(ff);
 }
@@ -412,6 +429,8 @@ init()
 		tab[i].cput = tbuf.cput;
 		tsys += tbuf.syst;
 		tab[i].syst = tbuf.syst;
+		tio += tbuf.iot;
+		tab[i].iot = tbuf.iot;
 	}
 	fclose(f);
  gshm:
@@ -464,6 +483,7 @@ strip()
 				tab[j].realt += tab[i].realt;
 				tab[j].cput += tab[i].cput;
 				tab[j].syst += tab[i].syst;
+				tab[j].iot += tab[i].iot;
 			}
 			while (c && c!='\n')
 				c = getchar();
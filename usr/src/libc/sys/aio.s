@@ -0,0 +1,27 @@
+/ C library -- aio
+
+/ result = aio(cmd, arg, buffer, count);
+/ asynchronous raw I/O: cmd is AIOREAD or AIOWRITE,
+/ with arg a file descriptor, or AIOWAIT or AIOPOLL,
+/ with arg a handle (sys/uio.h)
+
+.globl	_aio
+.globl	cerror
+.aio = 49.
+
+_aio:
+	mov	r5,-(sp)
+	mov	sp,r5
+	mov	4(r5),0f
+	mov	6(r5),0f+2
+	mov	8(r5),0f+4
+	mov	10.(r5),0f+6
+	sys	0; 9f
+	bec	1f
+	jmp	cerror
+1:
+	mov	(sp)+,r5
+	rts	pc
+.data
+9:
+	sys	.aio; 0: .=.+8.
@@ -0,0 +1,25 @@
+/ C library -- fmap
+
+/ addr = fmap(file, segno, bno);
+/ maps up to 8K of file, from block bno,
+/ read-only at segno*8K; file -1 unmaps
+
+.globl	_fmap
+.globl	cerror
+.fmap = 50.
+
+_fmap:
+	mov	r5,-(sp)
+	mov	sp,r5
+	mov	4(r5),r0
+	mov	6(r5),0f
+	mov	8(r5),0f+2
+	sys	0; 9f
+	bec	1f
+	jmp	cerror
+1:
+	mov	(sp)+,r5
+	rts	pc
+.data
+9:
+	sys	.fmap; 0:..; ..
@@ -0,0 +1,25 @@
+/ C library -- readv
+
+/ nread = readv(file, iov, iovcnt);
+/ like read, but into the iovcnt buffers
+/ described by the iovec array iov
+
+.globl	_readv
+.globl	cerror
+.readv = 40.
+
+_readv:
+	mov	r5,-(sp)
+	mov	sp,r5
+	mov	4(r5),r0
+	mov	6(r5),0f
+	mov	8(r5),0f+2
+	sys	0; 9f
+	bec	1f
+	jmp	cerror
+1:
+	mov	(sp)+,r5
+	rts	pc
+.data
+9:
+	sys	.readv; 0:..; ..
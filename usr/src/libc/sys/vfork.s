@@ -0,0 +1,25 @@
+/ C library -- vfork
+
+/ pid = vfork();
+/
+/ pid == 0 in child process; pid == -1 means error return.
+/ The child runs in the parent's memory until it
+/ execs or exits, so the return address is kept
+/ in r1 rather than on the stack they share.
+
+.globl	_vfork
+.comm	_errno,2
+.vfork = 45.
+
+_vfork:
+	mov	(sp)+,r1
+	sys	.vfork
+		br 1f
+	bec	2f
+	mov	r0,_errno
+	mov	$-1,r0
+	jmp	(r1)
+1:
+	clr	r0
+2:
+	jmp	(r1)
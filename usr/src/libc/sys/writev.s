@@ -0,0 +1,25 @@
+/ C library -- writev
+
+/ nwritten = writev(file, iov, iovcnt);
+/ like write, but from the iovcnt buffers
+/ described by the iovec array iov
+
+.globl	_writev
+.globl	cerror
+.writev = 62.
+
+_writev:
+	mov	r5,-(sp)
+	mov	sp,r5
+	mov	4(r5),r0
+	mov	6(r5),0f
+	mov	8(r5),0f+2
+	sys	0; 9f
+	bec	1f
+	jmp	cerror
+1:
+	mov	(sp)+,r5
+	rts	pc
+.data
+9:
+	sys	.writev; 0:..; ..
@@ -938,9 +938,11 @@ _ka6:	KDSA6
 _cputype:45.
 stk:	0
 
+.globl	_ssr
 .bss
 nofault:.=.+2
 fpp:	.=.+2
+_ssr:
 ssr:	.=.+6
 dispdly:.=.+2
 saveps:	.=.+2
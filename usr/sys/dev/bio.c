@@ -16,17 +16,54 @@ struct {
 	long	nreada;
 	long	ncache;
 	long	nwrite;
+	long	nhlook;		/* hash chain searches */
+	long	nhprobe;	/* buffers examined in those searches */
+	int	nhmax;		/* longest search seen */
+	long	nhchain[8];	/* searches by length, last is >= 7 */
+	long	nrahit;		/* read-ahead blocks later asked for */
+	long	nrawaste;	/* read-ahead blocks reused unasked */
+	long	nwbehind;	/* delayed writes pushed by write-behind */
+	long	nwtrick;	/* delayed writes pushed by the flusher */
+	long	ndwage[8];	/* delayed writes by age, 0, 1, 2-3, ... 64- secs */
 	long	bufcount[NBUF];
 } io_info;
 #endif
 
+/*
+ * Heads of the (dev, blkno) hash chains.
+ */
+struct	buf	*bhash[BUFHSZ];
+
+/*
+ * Buffers waiting for a delayed write, in
+ * the order they were dirtied, and how many.
+ */
+struct	buf	*bdirtyh;
+struct	buf	**bdirtyt = &bdirtyh;
+int	nbdirty;
+
 /*
  * swap IO headers.
  * they are filled in to point
- * at the desired IO operation.
+ * at the desired IO operation;
+ * swowner is the process waiting for each.
  */
-struct	buf	swbuf1;
-struct	buf	swbuf2;
+struct	buf	swbuf[NSWBUF];
+struct	proc	*swowner[NSWBUF];
+char	swwant;
+
+struct	buf	aiobuf[NAIO];
+struct	proc	*aioowner[NAIO];
+
+/*
+ * Swap traffic, for iostat.
+ */
+struct {
+	long	nswin;		/* transfers from swap */
+	long	nswout;		/* transfers to swap */
+	long	swinclk;	/* clicks read */
+	long	swoutclk;	/* clicks written */
+} sw_info;
 
 /*
  * The following several routines allocate and free
@@ -41,12 +78,15 @@ struct	buf	swbuf2;
  *	getblk
  *	bread
  *	breada
+ *	breadn
  * Eventually the buffer must be released, possibly with the
  * side effect of writing it out, by using one of
  *	bwrite
  *	bdwrite
  *	bawrite
  *	brelse
+ * Delayed writes are pushed out early by write-behind
+ * (bwbehind) and by age (the flusher, bflushd).
  */
 
 /*
@@ -64,6 +104,7 @@ daddr_t blkno;
 #ifdef	DISKMON
 		io_info.ncache++;
 #endif
+		u.u_iohit++;
 		return(bp);
 	}
 	bp->b_flags |= B_READ;
@@ -72,6 +113,7 @@ daddr_t blkno;
 #ifdef	DISKMON
 	io_info.nread++;
 #endif
+	u.u_ior++;
 	iowait(bp);
 	return(bp);
 }
@@ -85,7 +127,23 @@ breada(dev, blkno, rablkno)
 dev_t dev;
 daddr_t blkno, rablkno;
 {
-	register struct buf *bp, *rabp;
+
+	return(breadn(dev, blkno, &rablkno, rablkno? 1: 0));
+}
+
+/*
+ * Read in the block, like bread, but also start I/O on
+ * the nra blocks in rablks, all queued to the driver
+ * before waiting for the first.
+ */
+struct buf *
+breadn(dev, blkno, rablks, nra)
+dev_t dev;
+daddr_t blkno;
+register daddr_t *rablks;
+register nra;
+{
+	register struct buf *bp;
 
 	bp = NULL;
 	if (!incore(dev, blkno)) {
@@ -97,27 +155,44 @@ daddr_t blkno, rablkno;
 #ifdef	DISKMON
 			io_info.nread++;
 #endif
+			u.u_ior++;
 		}
 	}
-	if (rablkno && !incore(dev, rablkno)) {
-		rabp = getblk(dev, rablkno);
-		if (rabp->b_flags & B_DONE)
-			brelse(rabp);
-		else {
-			rabp->b_flags |= B_READ|B_ASYNC;
-			rabp->b_bcount = BSIZE;
-			(*bdevsw[major(dev)].d_strategy)(rabp);
-#ifdef	DISKMON
-			io_info.nreada++;
-#endif
-		}
-	}
+	while (--nra >= 0)
+		brahead(dev, *rablks++);
 	if(bp == NULL)
 		return(bread(dev, blkno));
 	iowait(bp);
 	return(bp);
 }
 
+/*
+ * Start an asynchronous read of a block
+ * nobody has asked for yet, unless it is
+ * already in core.
+ */
+brahead(dev, rablkno)
+dev_t dev;
+daddr_t rablkno;
+{
+	register struct buf *rabp;
+
+	if (rablkno==0 || incore(dev, rablkno))
+		return;
+	rabp = getblk(dev, rablkno);
+	if (rabp->b_flags & B_DONE) {
+		brelse(rabp);
+		return;
+	}
+	rabp->b_flags |= B_READ|B_ASYNC|B_RA;
+	rabp->b_bcount = BSIZE;
+	(*bdevsw[major(dev)].d_strategy)(rabp);
+#ifdef	DISKMON
+	io_info.nreada++;
+#endif
+	u.u_ior++;
+}
+
 /*
  * Write the buffer, waiting for completion.
  * Then release the buffer.
@@ -130,9 +205,26 @@ register struct buf *bp;
 	flag = bp->b_flags;
 	bp->b_flags &= ~(B_READ | B_DONE | B_ERROR | B_DELWRI | B_AGE);
 	bp->b_bcount = BSIZE;
+	if (flag & B_DELWRI)
+		bdrem(bp);
 #ifdef	DISKMON
 	io_info.nwrite++;
+	if (flag & B_DELWRI) {
+		register i;
+		time_t age;
+
+		age = time - bp->b_dtime;
+		for (i = 0; i < 7 && age > 0; i++)
+			age >>= 1;
+		io_info.ndwage[i]++;
+	}
 #endif
+	/*
+	 * A delayed write was charged
+	 * to whoever dirtied the block.
+	 */
+	if ((flag&B_DELWRI) == 0)
+		u.u_iow++;
 	(*bdevsw[major(bp->b_dev)].d_strategy)(bp);
 	if ((flag&B_ASYNC) == 0) {
 		iowait(bp);
@@ -160,11 +252,90 @@ register struct buf *bp;
 	if(dp->b_flags & B_TAPE)
 		bawrite(bp);
 	else {
+		if ((bp->b_flags&B_DELWRI) == 0) {
+			bp->b_dtime = time;
+			u.u_iow++;
+			bdlink(bp);
+		}
 		bp->b_flags |= B_DELWRI | B_DONE;
 		brelse(bp);
 	}
 }
 
+/*
+ * Put a newly dirtied buffer at the
+ * tail of the delayed-write list,
+ * and take one off it.
+ */
+bdlink(bp)
+register struct buf *bp;
+{
+	register s;
+
+	s = spl6();
+	bp->b_dforw = NULL;
+	bp->b_dback = bdirtyt;
+	*bdirtyt = bp;
+	bdirtyt = &bp->b_dforw;
+	nbdirty++;
+	splx(s);
+}
+
+bdrem(bp)
+register struct buf *bp;
+{
+	register s;
+
+	s = spl6();
+	if (bp->b_dback != NULL) {
+		if (bp->b_dforw != NULL)
+			bp->b_dforw->b_dback = bp->b_dback;
+		else
+			bdirtyt = bp->b_dback;
+		*bp->b_dback = bp->b_dforw;
+		bp->b_dforw = NULL;
+		bp->b_dback = NULL;
+		nbdirty--;
+	}
+	splx(s);
+}
+
+/*
+ * Write-behind, called by writei after it has
+ * filled block bn with a delayed write.
+ * When WBCLUST consecutive blocks ending with bn
+ * are all waiting to be written, start them
+ * together, so the driver's disksort can
+ * lay them down in one sweep while the
+ * writer goes on filling the next ones.
+ */
+bwbehind(dev, bn)
+dev_t dev;
+daddr_t bn;
+{
+	register struct buf *bp;
+	register i;
+
+	for (i = 0; i < WBCLUST; i++) {
+		bp = bhfind(dev, bn-i);
+		if (bp==NULL || (bp->b_flags&(B_DELWRI|B_BUSY)) != B_DELWRI)
+			return;
+	}
+	for (i = WBCLUST-1; i >= 0; i--) {
+		spl6();
+		bp = bhfind(dev, bn-i);
+		if (bp!=NULL && (bp->b_flags&(B_DELWRI|B_BUSY)) == B_DELWRI) {
+			notavail(bp);
+			spl0();
+#ifdef	DISKMON
+			io_info.nwbehind++;
+#endif
+			bawrite(bp);
+		}
+		spl0();
+	}
+}
+
 /*
  * Release the buffer, start I/O on it, but don't wait for completion.
  */
@@ -218,15 +389,75 @@ register struct buf *bp;
 incore(dev, blkno)
 dev_t dev;
 daddr_t blkno;
+{
+
+	return(bhfind(dev, blkno) != NULL);
+}
+
+/*
+ * Find the buffer associated with
+ * the block by searching its hash chain.
+ * The buffer may be busy.
+ */
+struct buf *
+bhfind(dev, blkno)
+dev_t dev;
+daddr_t blkno;
 {
 	register struct buf *bp;
-	register struct buf *dp;
+#ifdef	DISKMON
+	register i;
 
-	dp = bdevsw[major(dev)].d_tab;
-	for (bp=dp->b_forw; bp != dp; bp = bp->b_forw)
+	i = 0;
+#endif
+	for (bp = bhash[BUFHASH(dev, blkno)]; bp != NULL; bp = bp->b_hlink) {
+#ifdef	DISKMON
+		i++;
+#endif
 		if (bp->b_blkno==blkno && bp->b_dev==dev)
-			return(1);
-	return(0);
+			break;
+	}
+#ifdef	DISKMON
+	io_info.nhlook++;
+	io_info.nhprobe += i;
+	if (i > io_info.nhmax)
+		io_info.nhmax = i;
+	io_info.nhchain[i<7? i: 7]++;
+#endif
+	return(bp);
+}
+
+/*
+ * Enter a buffer on the hash chain for its
+ * current dev and blkno.
+ */
+bhashin(bp)
+register struct buf *bp;
+{
+	register struct buf **hp;
+
+	hp = &bhash[BUFHASH(bp->b_dev, bp->b_blkno)];
+	if ((bp->b_hlink = *hp) != NULL)
+		(*hp)->b_hback = &bp->b_hlink;
+	bp->b_hback = hp;
+	*hp = bp;
+}
+
+/*
+ * Take a buffer off whatever hash chain it is on.
+ * The chain need not match b_dev, which brelse
+ * sets to NODEV after an error.
+ */
+bunhash(bp)
+register struct buf *bp;
+{
+
+	if (bp->b_hback == NULL)
+		return;
+	if ((*bp->b_hback = bp->b_hlink) != NULL)
+		bp->b_hlink->b_hback = bp->b_hback;
+	bp->b_hlink = NULL;
+	bp->b_hback = NULL;
 }
 
 /*
@@ -253,9 +484,7 @@ daddr_t blkno;
 	dp = bdevsw[major(dev)].d_tab;
 	if(dp == NULL)
 		panic("devtab");
-	for (bp=dp->b_forw; bp != dp; bp = bp->b_forw) {
-		if (bp->b_blkno!=blkno || bp->b_dev!=dev)
-			continue;
+	if ((bp = bhfind(dev, blkno)) != NULL) {
 		spl6();
 		if (bp->b_flags&B_BUSY) {
 			bp->b_flags |= B_WANTED;
@@ -264,6 +493,8 @@ daddr_t blkno;
 		}
 		spl0();
 #ifdef	DISKMON
+		if (bp->b_flags&B_RA)
+			io_info.nrahit++;
 		i = 0;
 		dp = bp->av_forw;
 		while (dp != &bfreelist) {
@@ -274,6 +505,7 @@ daddr_t blkno;
 			io_info.bufcount[i]++;
 #endif
 		notavail(bp);
+		bp->b_flags &= ~B_RA;
 		return(bp);
 	}
 	spl6();
@@ -289,7 +521,12 @@ daddr_t blkno;
 		bwrite(bp);
 		goto loop;
 	}
+#ifdef	DISKMON
+	if (bp->b_flags&B_RA)
+		io_info.nrawaste++;
+#endif
 	bp->b_flags = B_BUSY;
+	bunhash(bp);
 	bp->b_back->b_forw = bp->b_forw;
 	bp->b_forw->b_back = bp->b_back;
 	bp->b_forw = dp->b_forw;
@@ -298,6 +535,7 @@ daddr_t blkno;
 	dp->b_forw = bp;
 	bp->b_dev = dev;
 	bp->b_blkno = blkno;
+	bhashin(bp);
 	return(bp);
 }
 
@@ -325,7 +563,12 @@ loop:
 		bwrite(bp);
 		goto loop;
 	}
+#ifdef	DISKMON
+	if (bp->b_flags&B_RA)
+		io_info.nrawaste++;
+#endif
 	bp->b_flags = B_BUSY;
+	bunhash(bp);
 	bp->b_back->b_forw = bp->b_forw;
 	bp->b_forw->b_back = bp->b_back;
 	bp->b_forw = dp->b_forw;
@@ -343,10 +586,13 @@ loop:
 iowait(bp)
 register struct buf *bp;
 {
+	long t;
 
 	spl6();
+	t = lticks;
 	while ((bp->b_flags&B_DONE)==0)
 		sleep((caddr_t)bp, PRIBIO);
+	u.u_iowt += lticks - t;
 	spl0();
 	geterror(bp);
 }
@@ -404,24 +650,36 @@ struct buf *bp;
 }
 
 /*
- * swap I/O
+ * swap I/O.
+ * A transfer is split into chunks, each on a header
+ * of its own, and all of them are handed to the driver
+ * at once, so disksort can order them among the
+ * transfers of other images.  swstart only queues
+ * a transfer; swwait waits for all those queued by
+ * the current process.  swap does both.
  */
 swap(blkno, coreaddr, count, rdflg)
+{
+
+	swstart(blkno, coreaddr, count, rdflg);
+	swwait();
+}
+
+swstart(blkno, coreaddr, count, rdflg)
 register count;
 {
 	register struct buf *bp;
 	register tcount;
 
-	bp = &swbuf1;
-	if(bp->b_flags & B_BUSY)
-		if((swbuf2.b_flags&B_WANTED) == 0)
-			bp = &swbuf2;
-	spl6();
-	while (bp->b_flags&B_BUSY) {
-		bp->b_flags |= B_WANTED;
-		sleep((caddr_t)bp, PSWP+1);
+	if (rdflg) {
+		sw_info.nswin++;
+		sw_info.swinclk += count;
+	} else {
+		sw_info.nswout++;
+		sw_info.swoutclk += count;
 	}
 	while (count) {
+		bp = swget();
 		bp->b_flags = B_BUSY | B_PHYS | rdflg;
 		bp->b_dev = swapdev;
 		tcount = count;
@@ -432,19 +690,106 @@ register count;
 		bp->b_un.b_addr = (caddr_t)(coreaddr<<6);
 		bp->b_xmem = (coreaddr>>10) & 077;
 		(*bdevsw[major(swapdev)].d_strategy)(bp);
-		spl6();
-		while((bp->b_flags&B_DONE)==0)
-			sleep((caddr_t)bp, PSWP);
 		count -= tcount;
 		coreaddr += tcount;
 		blkno += ctod(tcount);
 	}
-	if (bp->b_flags&B_WANTED)
-		wakeup((caddr_t)bp);
+}
+
+/*
+ * Get a free swap header for the current process.
+ * If all are busy and some are its own, it waits
+ * for its own transfers first.
+ */
+struct buf *
+swget()
+{
+	register struct buf *bp;
+	register struct proc *p;
+
+	p = u.u_procp;
+	for (;;) {
+		spl6();
+		for (bp = &swbuf[0]; bp < &swbuf[NSWBUF]; bp++)
+			if ((bp->b_flags&B_BUSY) == 0) {
+				bp->b_flags = B_BUSY;
+				swowner[bp-swbuf] = p;
+				spl0();
+				return(bp);
+			}
+		for (bp = &swbuf[0]; bp < &swbuf[NSWBUF]; bp++)
+			if (swowner[bp-swbuf] == p)
+				break;
+		if (bp < &swbuf[NSWBUF])
+			swwait();
+		else {
+			swwant++;
+			sleep((caddr_t)swbuf, PSWP+1);
+		}
+	}
+}
+
+/*
+ * Wait for the swap transfers queued
+ * by the current process to finish.
+ */
+swwait()
+{
+	register struct buf *bp;
+	register struct proc *p;
+
+	p = u.u_procp;
+	spl6();
+	for (bp = &swbuf[0]; bp < &swbuf[NSWBUF]; bp++) {
+		if (swowner[bp-swbuf] != p)
+			continue;
+		while ((bp->b_flags&B_DONE) == 0)
+			sleep((caddr_t)bp, PSWP);
+		if (bp->b_flags & B_ERROR)
+			panic("IO err in swap");
+		swowner[bp-swbuf] = NULL;
+		bp->b_flags = 0;
+	}
+	if (swwant) {
+		swwant = 0;
+		wakeup((caddr_t)swbuf);
+	}
 	spl0();
-	bp->b_flags &= ~(B_BUSY|B_WANTED);
-	if (bp->b_flags & B_ERROR)
-		panic("IO err in swap");
+}
+
+/*
+ * Read count bytes from block blkno of dev
+ * straight into core at click coreaddr plus
+ * off bytes, on a swap header, and wait.
+ * Used by exec to read whole runs of blocks
+ * of a program; errors go to u_error.
+ */
+physrd(dev, blkno, coreaddr, off, count)
+dev_t dev;
+daddr_t blkno;
+{
+	register struct buf *bp;
+
+	bp = swget();
+	bp->b_flags = B_BUSY | B_PHYS | B_READ;
+	bp->b_dev = dev;
+	bp->b_blkno = blkno;
+	bp->b_bcount = count;
+	bp->b_un.b_addr = (caddr_t)((coreaddr<<6) + off);
+	bp->b_xmem = (coreaddr>>10) & 077;
+	bp->b_error = 0;
+	(*bdevsw[major(dev)].d_strategy)(bp);
+	spl6();
+	while ((bp->b_flags&B_DONE) == 0)
+		sleep((caddr_t)bp, PRIBIO);
+	spl0();
+	geterror(bp);
+	swowner[bp-swbuf] = NULL;
+	bp->b_flags = 0;
+	if (swwant) {
+		swwant = 0;
+		wakeup((caddr_t)swbuf);
+	}
 }
 
 /*
@@ -452,23 +797,79 @@ register count;
  * on dev (or NODEV for all)
  * are flushed out.
  * (from umount and update)
+ * Only the delayed-write list is walked.
+ * Returns the number of writes started.
  */
 bflush(dev)
 dev_t dev;
 {
-	register struct buf *bp;
+	register struct buf *bp, *nbp;
+	register n;
 
-loop:
+	/*
+	 * Buffers only join the list at the tail
+	 * while we write, so it is safe to carry on
+	 * from the successor rather than start over.
+	 * Busy buffers are left for their holders.
+	 */
+	n = 0;
 	spl6();
-	for (bp = bfreelist.av_forw; bp != &bfreelist; bp = bp->av_forw) {
-		if (bp->b_flags&B_DELWRI && (dev == NODEV||dev==bp->b_dev)) {
+	for (bp = bdirtyh; bp != NULL; bp = nbp) {
+		nbp = bp->b_dforw;
+		if ((bp->b_flags&B_BUSY) == 0 && (dev == NODEV||dev==bp->b_dev)) {
 			bp->b_flags |= B_ASYNC;
 			notavail(bp);
 			bwrite(bp);
-			goto loop;
+			n++;
+			spl6();
 		}
 	}
 	spl0();
+	return(n);
+}
+
+/*
+ * The buffer flusher, run as a system process
+ * started by main.  Once a second it writes out
+ * up to NBTRICK delayed-write buffers that have
+ * waited BDAGE seconds or more, oldest first,
+ * so that dirty data trickles to the disk
+ * instead of piling up for update or for
+ * getblk to meet on its way to a free buffer.
+ * When many are waiting it writes more, so
+ * as to clear them in about BDAGE seconds
+ * rather than leave them for sync.
+ */
+bflushd()
+{
+	register struct buf *bp, *nbp;
+	register n;
+	int lim;
+
+	for (;;) {
+		sleep((caddr_t)&lbolt, PRIBIO);
+		n = 0;
+		lim = nbdirty/BDAGE;
+		if (lim < NBTRICK)
+			lim = NBTRICK;
+		spl6();
+		for (bp = bdirtyh; bp != NULL; bp = nbp) {
+			nbp = bp->b_dforw;
+			if (time - bp->b_dtime < BDAGE)
+				break;
+			if (bp->b_flags&B_BUSY)
+				continue;
+			notavail(bp);
+#ifdef	DISKMON
+			io_info.nwtrick++;
+#endif
+			bawrite(bp);
+			spl6();
+			if (++n >= lim)
+				break;
+		}
+		spl0();
+	}
 }
 
 /*
@@ -480,6 +881,10 @@ loop:
  *	Read/write flag
  * Essentially all the work is computing physical addresses and
  * validating them.
+ * If aio has left a header in u_abp, it is used
+ * instead, and physio returns once the transfer has
+ * started, as if it were complete; the process stays
+ * in core (SAIO) until aio collects the result.
  */
 physio(strat, bp, dev, rw)
 register struct buf *bp;
@@ -487,7 +892,8 @@ int (*strat)();
 {
 	register unsigned base;
 	register int nb;
-	int ts;
+	int ts, async;
+	long t;
 
 	base = (unsigned)u.u_base;
 	/*
@@ -515,6 +921,12 @@ int (*strat)();
 	    && nb < 1024-u.u_ssize)
 		goto bad;
 	spl6();
+	async = 0;
+	if (u.u_abp != NULL) {
+		bp = u.u_abp;
+		u.u_abp = NULL;
+		async++;
+	} else
 	while (bp->b_flags&B_BUSY) {
 		bp->b_flags |= B_WANTED;
 		sleep((caddr_t)bp, PRIBIO+1);
@@ -531,11 +943,23 @@ int (*strat)();
 	bp->b_blkno = u.u_offset >> BSHIFT;
 	bp->b_bcount = u.u_count;
 	bp->b_error = 0;
-	u.u_procp->p_flag |= SLOCK;
+	if (!async)
+		u.u_procp->p_flag |= SLOCK;
+	t = (u.u_count>>BSHIFT) + ((u.u_count&BMASK)!=0);
+	if (rw == B_READ)
+		u.u_ior += t; else
+		u.u_iow += t;
 	(*strat)(bp);
+	if (async) {
+		spl0();
+		u.u_count = 0;
+		return;
+	}
 	spl6();
+	t = lticks;
 	while ((bp->b_flags&B_DONE) == 0)
 		sleep((caddr_t)bp, PRIBIO);
+	u.u_iowt += lticks - t;
 	u.u_procp->p_flag &= ~SLOCK;
 	if (bp->b_flags&B_WANTED)
 		wakeup((caddr_t)bp);
@@ -548,6 +972,87 @@ int (*strat)();
 	u.u_error = EFAULT;
 }
 
+/*
+ * Get a header for an asynchronous raw
+ * transfer by the current process.
+ */
+struct buf *
+aioget()
+{
+	register struct buf *bp;
+
+	for (bp = &aiobuf[0]; bp < &aiobuf[NAIO]; bp++)
+		if (aioowner[bp-aiobuf] == NULL) {
+			aioowner[bp-aiobuf] = u.u_procp;
+			bp->b_flags = B_BUSY;
+			u.u_procp->p_flag |= SAIO;
+			return(bp);
+		}
+	return(NULL);
+}
+
+/*
+ * Wait for an asynchronous transfer to
+ * finish and free its header.
+ * Returns the count of bytes moved.
+ */
+aiowait(bp)
+register struct buf *bp;
+{
+	register struct buf *xp;
+	register n;
+
+	spl6();
+	while ((bp->b_flags&B_DONE) == 0)
+		sleep((caddr_t)bp, PRIBIO);
+	spl0();
+	n = bp->b_bcount - bp->b_resid;
+	geterror(bp);
+	bp->b_flags = 0;
+	aioowner[bp-aiobuf] = NULL;
+	for (xp = &aiobuf[0]; xp < &aiobuf[NAIO]; xp++)
+		if (aioowner[xp-aiobuf] == u.u_procp)
+			return(n);
+	u.u_procp->p_flag &= ~SAIO;
+	return(n);
+}
+
+/*
+ * Give back the header aio left in u_abp,
+ * if the call was interrupted before physio
+ * took it, so that a later raw read or
+ * write is not made asynchronous.
+ */
+aioclear()
+{
+	register struct buf *bp;
+
+	if ((bp = u.u_abp) == NULL)
+		return;
+	u.u_abp = NULL;
+	bp->b_flags |= B_DONE;
+	aiowait(bp);
+}
+
+/*
+ * Finish all the current process's
+ * asynchronous transfers, before its
+ * image is moved, replaced or released.
+ */
+aiodrain()
+{
+	register struct buf *bp;
+	int e;
+
+	if ((u.u_procp->p_flag&SAIO) == 0)
+		return;
+	e = u.u_error;
+	for (bp = &aiobuf[0]; bp < &aiobuf[NAIO]; bp++)
+		if (aioowner[bp-aiobuf] == u.u_procp)
+			aiowait(bp);
+	u.u_error = e;
+}
+
 /*
  * Pick up the device's error number and pass it to the user;
  * if there is an error but the number is 0 set a generalized
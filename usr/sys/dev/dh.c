@@ -159,13 +159,21 @@ register struct tty *tp;
 
 /*
  * DH11 receiver interrupt.
+ * Characters for raw lines in the standard
+ * discipline are collected in rbuf and passed
+ * up together by ttyrend.
  */
 dhrint(dev)
 {
 	register struct tty *tp;
 	register int c;
 	register struct device *addr;
+	struct tty *rtp;
+	char *rp;
+	char rbuf[TTRBULK];
 
+	rtp = NULL;
+	rp = rbuf;
 	addr = DHADDR;
 	addr += minor(dev);
 	while ((c = addr->dhnxch) < 0) {	/* char. present */
@@ -186,8 +194,20 @@ dhrint(dev)
 				c = 0;	/* null (for getty) */
 			else
 				c = 0177;	/* DEL (intr) */
+		if ((tp->t_flags&RAW) && tp->t_line==0) {
+			if (tp != rtp || rp >= &rbuf[TTRBULK]) {
+				if (rp > rbuf)
+					ttyrend(rtp, rbuf, rp);
+				rtp = tp;
+				rp = rbuf;
+			}
+			*rp++ = c;
+			continue;
+		}
 		(*linesw[tp->t_line].l_rint)(c,tp);
 	}
+	if (rp > rbuf)
+		ttyrend(rtp, rbuf, rp);
 }
 
 /*
@@ -7,22 +7,96 @@
 #include "../h/buf.h"
 
 #define	b_cylin	b_resid
+#define	b_qtime	b_dtime		/* not needed while on a drive queue */
 
+/*
+ * Scheduling policy; may be patched.
+ *	DS_RFIRST	one-way cylinder sort, reads before writes
+ *	DS_CLOOK	circular elevator: ascending cylinders,
+ *			then back to the lowest
+ *	DS_DLINE	C-LOOK, but nothing is put ahead of
+ *			a request that has waited past its deadline
+ */
+#define	DS_RFIRST	0
+#define	DS_CLOOK	1
+#define	DS_DLINE	2
+int	dsortpol = DS_DLINE;
+
+/*
+ * Deadlines in seconds; reads are
+ * kept waiting less than writes.
+ * Queue times are kept in clock ticks.
+ */
+int	dsrdline = 1;
+int	dswrline = 4;
+
+/*
+ * Place bp on the queue headed by dp.
+ * The first request on the queue may be
+ * active and is never displaced.
+ * Returns the number of requests that were
+ * already queued, for the drivers' statistics.
+ */
 disksort(dp, bp)
 register struct buf *dp, *bp;
 {
 	register struct buf *ap;
 	struct buf *tp;
+	int n;
+	struct buf *rfsort(), *clook();
 
+	bp->b_qtime = lticks;
 	ap = dp->b_actf;
 	if(ap == NULL) {
 		dp->b_actf = bp;
 		dp->b_actl = bp;
 		bp->av_forw = NULL;
-		return;
+		return(0);
+	}
+	if(dsortpol == DS_RFIRST)
+		tp = rfsort(ap, bp);
+	else
+		tp = clook(ap, bp);
+	/*
+	 * A request for the block after one already
+	 * queued follows it directly, so the drive
+	 * can take both without moving.
+	 */
+	n = 0;
+	for(ap = dp->b_actf; ap != NULL; ap = ap->av_forw) {
+		n++;
+		if(ap->b_dev == bp->b_dev && ap->b_blkno+1 == bp->b_blkno &&
+		   (ap->b_flags&B_READ) == (bp->b_flags&B_READ))
+			tp = ap;
 	}
+	/*
+	 * Never pass a request that is past its deadline.
+	 */
+	if(dsortpol == DS_DLINE)
+		for(ap = tp->av_forw; ap != NULL; ap = ap->av_forw)
+			if(dsexpired(ap))
+				tp = ap;
+	bp->av_forw = tp->av_forw;
+	tp->av_forw = bp;
+	if(tp == dp->b_actl)
+		dp->b_actl = bp;
+	return(n);
+}
+
+/*
+ * The original sort: one-way by cylinder,
+ * with reads ahead of writes.
+ * Returns the request bp is to follow.
+ */
+struct buf *
+rfsort(ap, bp)
+register struct buf *ap, *bp;
+{
+	struct buf *tp, *lp;
+
 	tp = NULL;
 	for(; ap != NULL; ap = ap->av_forw) {
+		lp = ap;
 		if ((bp->b_flags&B_READ) && (ap->b_flags&B_READ) == 0) {
 			if (tp == NULL)
 				tp = ap;
@@ -35,9 +109,67 @@ register struct buf *dp, *bp;
 				tp = ap;
 	}
 	if(tp == NULL)
-		tp = dp->b_actl;
-	bp->av_forw = tp->av_forw;
-	tp->av_forw = bp;
-	if(tp == dp->b_actl)
-		dp->b_actl = bp;
+		tp = lp;
+	return(tp);
+}
+
+/*
+ * C-LOOK.  The queue is at most two ascending
+ * runs: the rest of the current sweep, from
+ * the cylinder of the first request up, and the
+ * next sweep, which starts where the cylinder
+ * numbers first go down.  bp joins the current
+ * sweep if it is not below the first request,
+ * otherwise the next one; within a cylinder
+ * requests are kept in block order.
+ * Returns the request bp is to follow.
+ */
+struct buf *
+clook(ap, bp)
+register struct buf *ap, *bp;
+{
+	register struct buf *np;
+
+	if(bp->b_cylin < ap->b_cylin) {
+		/*
+		 * skip the current sweep
+		 */
+		for(; (np = ap->av_forw) != NULL; ap = np)
+			if(np->b_cylin < ap->b_cylin)
+				break;
+	}
+	for(; (np = ap->av_forw) != NULL; ap = np) {
+		if(np->b_cylin < ap->b_cylin)
+			break;
+		if(bp->b_cylin < np->b_cylin)
+			break;
+		if(bp->b_cylin == np->b_cylin && bp->b_blkno < np->b_blkno)
+			break;
+	}
+	return(ap);
+}
+
+/*
+ * Has the request waited past its deadline?
+ */
+dsexpired(bp)
+register struct buf *bp;
+{
+
+	return(lticks - bp->b_qtime >
+	    (long)HZ*((bp->b_flags&B_READ)? dsrdline: dswrline));
+}
+
+/*
+ * Called by the drivers as request bp completes
+ * on drive n, to add up its time queued and in
+ * transfer, and the reads.
+ */
+dsdone(n, bp)
+register struct buf *bp;
+{
+
+	dk_wait[n] += lticks - bp->b_qtime;
+	if(bp->b_flags&B_READ)
+		dk_nrd[n]++;
 }
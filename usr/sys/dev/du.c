@@ -79,6 +79,7 @@ register dev;
 
 duclose(dev)
 {
+	int dutimeout();
 	register struct du *dp;
 	register struct dureg *lp;
 
@@ -87,6 +88,7 @@ duclose(dev)
 	lp->rxcsr = 0;
 	lp->txcsr = 0;
 	dp->du_timer = 0;
+	untimeout(dutimeout, (caddr_t)dp);
 	dp->du_proc = 0;
 	if (dp->du_buf != NULL) {
 		brelse(dp->du_buf);
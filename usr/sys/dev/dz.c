@@ -142,12 +142,21 @@ dzparam(dev)
 	dzaddr->dzlpr = lpr;
 }
 
+/*
+ * Characters for raw lines are collected
+ * in rbuf and passed up together by ttyrend.
+ */
 dzrint(dev)
 {
 	register struct tty *tp;
 	register c;
 	register struct device *dzaddr;
+	struct tty *rtp;
+	char *rp;
+	char rbuf[TTRBULK];
 
+	rtp = NULL;
+	rp = rbuf;
 	dzaddr = dz_addr[dev];
 	while ((c = dzaddr->dzrbuf) < 0) {	/* char. present */
 		tp = &dz_tty[((c>>8)&07)|(dev<<3)];
@@ -166,8 +175,20 @@ dzrint(dev)
 			if ((tp->t_flags&(EVENP|ODDP))==EVENP
 			 || (tp->t_flags&(EVENP|ODDP))==ODDP )
 				continue;
+		if (tp->t_flags&RAW) {
+			if (tp != rtp || rp >= &rbuf[TTRBULK]) {
+				if (rp > rbuf)
+					ttyrend(rtp, rbuf, rp);
+				rtp = tp;
+				rp = rbuf;
+			}
+			*rp++ = c;
+			continue;
+		}
 		ttyinput(c, tp);
 	}
+	if (rp > rbuf)
+		ttyrend(rtp, rbuf, rp);
 }
 
 dzxint(dev)
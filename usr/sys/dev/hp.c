@@ -132,7 +132,7 @@ register struct buf *bp;
 	unit = dkunit(bp);
 	dp = &hputab[unit];
 	spl5();
-	disksort(dp, bp);
+	dk_qlen[DK_N+NHP] += disksort(dp, bp);
 	if (dp->b_active == 0) {
 		hpustart(unit);
 		if(hptab.b_active == 0)
@@ -172,6 +172,8 @@ register unit;
 	cn = bp->b_cylin;
 	sn = bn%(NSECT*NTRAC);
 	sn = (sn+NSECT-SDIST)%NSECT;
+	csn = HPADDR->hpcc;
+	dk_seek[DK_N+NHP] += cn>csn? cn-csn: csn-cn;
 
 	if(HPADDR->hpcc != cn)
 		goto search;
@@ -308,6 +310,7 @@ hpintr()
 			dp->b_errcnt = 0;
 			dp->b_actf = bp->av_forw;
 			bp->b_resid = -(HPADDR->hpwc<<1);
+			dsdone(DK_N+NHP, bp);
 			iodone(bp);
 			HPADDR->hpcs1.w = IE;
 			if(dp->b_actf)
@@ -209,6 +209,12 @@ htstart()
 	}
 	if (h_openf[unit] < 0 || bp->b_blkno > h_nxrec[unit])
 		goto abort;
+	/*
+	 * Raw records are not positioned by block:
+	 * several may be queued by aio.
+	 */
+	if (bp->b_flags&B_PHYS)
+		blkno = h_blkno[unit] = bp->b_blkno;
 	if (blkno == bp->b_blkno) {
 		httab.b_active = SIO;
 		HTADDR->htba = bp->b_un.b_addr;
@@ -264,7 +270,7 @@ htintr()
 		err = HTADDR->hter;
 		if (HTADDR->htcs2&077400 || (err&HARD))
 			state = 0;
-		if (bp == &rhtbuf)
+		if (bp->b_flags&B_PHYS)
 			err &= ~FCE;
 		if ((bp->b_flags&B_READ) && (HTADDR->htds&PES))
 			err &= ~(CS|COR);
@@ -246,7 +246,7 @@ sw:
 		}
 		ip->i_mode = (ip->i_mode & ~IFMT) | IFMPC;
 		ip->i_count++;
-		ip->i_flag |= IACC|IUPD|ICHG;
+		imark(ip, IACC|IUPD|ICHG);
 		fp = u.u_ofile[u.u_r.r_val1];
 		fp->f_flag |= FMP;
 		fp->f_un.f_chan = NULL;
@@ -193,7 +193,7 @@ int	i, fmp;
 	i |= IFCHR;
 	ip->i_mode = i;
 	zero((caddr_t)gp, sizeof (struct group));
-	ip->i_flag |= IUPD|ICHG;
+	imark(ip, IUPD|ICHG);
 	iput(ip);
 }
 
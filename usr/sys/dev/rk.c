@@ -41,6 +41,13 @@ struct	device
 
 struct	buf	rktab;
 struct	buf	rrkbuf;
+int	rkcyl;			/* cylinder of last transfer */
+
+/*
+ * disksort key: drive, then cylinder
+ */
+#define	b_cylin	b_resid
+#define	rkcylin(dn, bn)	(((dn)<<8) + (int)((bn)/24))
 
 rkstrategy(bp)
 register struct buf *bp;
@@ -53,13 +60,9 @@ register struct buf *bp;
 		iodone(bp);
 		return;
 	}
-	bp->av_forw = (struct buf *)NULL;
+	bp->b_cylin = rkcylin(minor(bp->b_dev), bp->b_blkno);
 	spl5();
-	if(rktab.b_actf == NULL)
-		rktab.b_actf = bp;
-	else
-		rktab.b_actl->av_forw = bp;
-	rktab.b_actl = bp;
+	dk_qlen[DK_N] += disksort(&rktab, bp);
 	if(rktab.b_active == NULL)
 		rkstart();
 	spl0();
@@ -77,6 +80,9 @@ rkstart()
 	rktab.b_active++;
 	bn = bp->b_blkno;
 	dn = minor(bp->b_dev);
+	cn = rkcylin(dn, bn);
+	dk_seek[DK_N] += cn>rkcyl? cn-rkcyl: rkcyl-cn;
+	rkcyl = cn;
 	cn = bn/12;
 	sn = bn%12;
 	RKADDR->rkda = (dn<<13) | (cn<<4) | sn;
@@ -116,6 +122,7 @@ rkintr()
 	rktab.b_errcnt = 0;
 	rktab.b_actf = bp->av_forw;
 	bp->b_resid = 0;
+	dsdone(DK_N, bp);
 	iodone(bp);
 	rkstart();
 }
@@ -64,6 +64,14 @@ struct	buf	rrpbuf;
 
 #define	trksec	av_back
 #define	cylin	b_resid
+#define	b_cylin	b_resid
+
+/*
+ * disksort key: drive, then cylinder
+ */
+#define	rpcylin(unit, bn) \
+	((((unit)>>3)<<9) + (int)((bn)/(20*10)) + rp_sizes[(unit)&07].cyloff)
+int	rpcyl;			/* cylinder of last transfer */
 
 /*
  * Monitoring device number
@@ -86,15 +94,10 @@ register struct buf *bp;
 		iodone(bp);
 		return;
 	}
-	bp->av_forw = NULL;
-	unit >>= 3;
+	bp->b_cylin = rpcylin(unit, bp->b_blkno);
 	spl5();
 	dp = & rptab;
-	if (dp->b_actf == NULL)
-		dp->b_actf = bp;
-	else
-		dp->b_actl->av_forw = bp;
-	dp->b_actl = bp;
+	dk_qlen[DK_N] += disksort(dp, bp);
 	if (dp->b_active == NULL)
 		rpstart();
 	spl0();
@@ -114,6 +117,9 @@ rpstart()
 	unit = minor(bp->b_dev);
 	dn = unit>>3;
 	bn = bp->b_blkno;
+	cn = rpcylin(unit, bn);
+	dk_seek[DK_N] += cn>rpcyl? cn-rpcyl: rpcyl-cn;
+	rpcyl = cn;
 	cn = bn/(20*10) + rp_sizes[unit&07].cyloff;
 	sn = bn%(20*10);
 	tn = sn/10;
@@ -166,6 +172,7 @@ rpintr()
 	rptab.b_errcnt = 0;
 	rptab.b_actf = bp->av_forw;
 	bp->b_resid = 0;
+	dsdone(DK_N, bp);
 	iodone(bp);
 	rpstart();
 }
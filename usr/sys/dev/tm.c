@@ -187,6 +187,13 @@ tmstart()
 		return;
 	}
 	com = (unit<<8) | ((bp->b_xmem & 03) << 4) | IENABLE|DENS;
+	/*
+	 * Raw records are not positioned by block:
+	 * several may be queued by aio.  Not on a
+	 * retry, which must back up over the record.
+	 */
+	if ((bp->b_flags&B_PHYS) && tmtab.b_errcnt == 0)
+		*blkno = bp->b_blkno;
 	if (*blkno != bp->b_blkno) {
 		tmtab.b_active = SSEEK;
 		if (*blkno < bp->b_blkno) {
@@ -247,7 +254,7 @@ tmintr()
 				return;
 			}
 		} else
-			if (t_openf[unit]>0 && bp!=&rtmbuf &&
+			if (t_openf[unit]>0 && (bp->b_flags&B_PHYS)==0 &&
 				(TMADDR->tmer&EOF)==0 ) {
 				t_openf[unit] = -1;
 				deverror(bp, TMADDR->tmer, 0);
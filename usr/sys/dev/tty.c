@@ -347,6 +347,13 @@ register struct tty *tp;
 		sleep((caddr_t)&tp->t_rawq, TTIPRI);
 	}
 	spl0();
+	/*
+	 * In raw and cbreak modes there is nothing
+	 * to be done to the characters, so ttread
+	 * takes them straight from the raw queue.
+	 */
+	if (tp->t_flags&(RAW|CBREAK))
+		return(tp->t_rawq.c_cc);
 loop:
 	bp = &canonb[2];
 	while ((c=getc(&tp->t_rawq)) >= 0) {
@@ -382,6 +389,17 @@ loop:
 	}
 	bp1 = &canonb[2];
 	b_to_q(bp1, bp-bp1, &tp->t_canq);
+	ttyunblock(tp);
+	return(bp-bp1);
+}
+
+/*
+ * Send the start character once
+ * input blocked by ttyblock has drained.
+ */
+ttyunblock(tp)
+register struct tty *tp;
+{
 
 	if (tp->t_state&TBLOCK && tp->t_rawq.c_cc < TTYHOG/5) {
 		if (putc(tun.t_startc, &tp->t_outq)==0) {
@@ -390,13 +408,14 @@ loop:
 		}
 		tp->t_char = 0;
 	}
-
-	return(bp-bp1);
 }
 
 
 /*
  * block transfer input handler.
+ * Used by the interrupt routines to pass
+ * up characters received on raw lines
+ * several at a time.
  */
 ttyrend(tp, pb, pe)
 register struct tty *tp;
@@ -406,10 +425,20 @@ register char *pb, *pe;
 
 	tandem = tp->t_flags&TANDEM;
 	if (tp->t_flags&RAW) {
+		tk_nin += pe-pb;
+		if (tp->t_rawq.c_cc>TTYHOG) {
+			flushtty(tp);
+			return;
+		}
 		b_to_q(pb, pe-pb, &tp->t_rawq);
 		if (tp->t_chan)
 			sdata(tp->t_chan); else
 			wakeup((caddr_t)&tp->t_rawq);
+		if (tp->t_flags&ECHO) {
+			tk_nout += pe-pb;
+			b_to_q(pb, pe-pb, &tp->t_outq);
+			ttstart(tp);
+		}
 	} else {
 		tp->t_flags &= ~TANDEM;
 		while (pb < pe)
@@ -683,16 +712,30 @@ register struct tty *tp;
 /*
  * Called from device's read routine after it has
  * calculated the tty-structure given as argument.
+ * Characters are moved to the user through canonb
+ * a block at a time; in raw and cbreak modes they
+ * come straight from the raw queue once anything
+ * left on the canonical queue has been read.
  */
 ttread(tp)
 register struct tty *tp;
 {
+	register struct clist *qp;
+	register n;
 
 	if ((tp->t_state&CARR_ON)==0)
 		return(0);
-	if (tp->t_canq.c_cc || canon(tp))
-		while (tp->t_canq.c_cc && passc(getc(&tp->t_canq))>=0)
-			;
+	if (tp->t_canq.c_cc || canon(tp)) {
+		qp = tp->t_canq.c_cc? &tp->t_canq: &tp->t_rawq;
+		while (u.u_count && u.u_error==0) {
+			n = q_to_b(qp, canonb, min(u.u_count, CANBSIZ));
+			if (n <= 0)
+				break;
+			iomove(canonb, n, B_READ);
+		}
+		if (qp == &tp->t_rawq)
+			ttyunblock(tp);
+	}
 	return(tp->t_rawq.c_cc + tp->t_canq.c_cc);
 }
 
@@ -704,7 +747,9 @@ caddr_t
 ttwrite(tp)
 register struct tty *tp;
 {
-	register c;
+	register char *cp, *ce;
+	register n;
+	char *cb;
 
 	if ((tp->t_state&CARR_ON)==0)
 		return(NULL);
@@ -718,9 +763,38 @@ register struct tty *tp;
 			sleep((caddr_t)&tp->t_outq, TTOPRI);
 		}
 		spl0();
-		if ((c = cpass()) < 0)
+		/*
+		 * Take a block from the user into canonb.
+		 * Raw output is queued as it is; otherwise
+		 * runs of ordinary printing characters are
+		 * queued together and only the others go
+		 * through ttyoutput.
+		 */
+		n = u.u_count;
+		iomove(canonb, min(n, TTHIWAT), B_WRITE);
+		n -= u.u_count;
+		cp = canonb;
+		ce = cp+n;
+		if (tp->t_flags&RAW) {
+			tk_nout += n;
+			b_to_q(cp, n, &tp->t_outq);
+			cp = ce;
+		}
+		while (cp < ce) {
+			cb = cp;
+			if ((tp->t_flags&LCASE)==0)
+				while (cp < ce && (*cp&0200)==0 && (partab[*cp]&077)==0)
+					cp++;
+			if (n = cp-cb) {
+				tk_nout += n;
+				b_to_q(cb, n, &tp->t_outq);
+				tp->t_col += n;
+			}
+			if (cp < ce)
+				ttyoutput(*cp++, tp);
+		}
+		if (u.u_error)
 			break;
-		ttyoutput(c, tp);
 	}
 	ttstart(tp);
 	return(NULL);
@@ -38,10 +38,35 @@ struct buf
 	char	b_xmem;			/* high order core address */
 	char	b_error;		/* returned after I/O */
 	unsigned int b_resid;		/* words not transferred after error */
+	struct	buf *b_hlink;		/* hash chain on (dev, blkno) */
+	struct	buf **b_hback;		/* where b_hlink is pointed at us */
+	time_t	b_dtime;		/* when B_DELWRI was set */
+	struct	buf *b_dforw;		/* delayed writes, oldest first */
+	struct	buf **b_dback;		/*  "  */
 };
 
 extern struct buf buf[];		/* The buffer pool itself */
 extern struct buf bfreelist;		/* head of available list */
+extern struct buf *bdirtyh;		/* head of delayed-write list */
+
+/*
+ * Buffers associated with a block are also
+ * kept on one of BUFHSZ hash chains so that
+ * getblk and incore need not search the whole
+ * per-device list.  BUFHSZ must be a power of 2.
+ */
+#define	BUFHSZ	32
+#define	BUFHASH(dev, blkno)	((((int)(dev))+(int)(blkno)) & (BUFHSZ-1))
+
+extern struct buf *bhash[];		/* heads of the hash chains */
+
+/*
+ * Headers for asynchronous raw I/O (aio in sys2.c).
+ * aioowner is the process that started each
+ * transfer, or NULL if the header is free.
+ */
+extern struct buf aiobuf[];
+extern struct proc *aioowner[];
 
 /*
  * These flags are kept in b_flags.
@@ -60,6 +85,7 @@ extern struct buf bfreelist;		/* head of available list */
 #define	B_TAPE 02000	/* this is a magtape (no bdwrite) */
 #define	B_PBUSY	04000
 #define	B_PACK	010000
+#define	B_RA	020000	/* read ahead, not yet asked for */
 
 /*
  * special redeclarations for
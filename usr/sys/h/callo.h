@@ -6,12 +6,21 @@
  * in a specified amount of time.
  * Used, for example, to time tab
  * delays on typewriters.
+ *
+ * Pending callouts hang on a wheel of CWHEEL
+ * slots, one per tick, by the tick they are due
+ * modulo CWHEEL; the hand moves one slot each tick,
+ * so a call is found without looking at the others.
+ * Unused entries are kept on a free list.
  */
 
 struct	callo
 {
-	int	c_time;		/* incremental time */
+	int	c_time;		/* tick when due */
 	caddr_t	c_arg;		/* argument to routine */
 	int	(*c_func)();	/* routine */
+	struct	callo *c_next;	/* slot chain or free list */
 };
 struct	callo	callout[NCALL];
+
+#define	CWHEEL	64		/* must be a power of 2 */
@@ -13,10 +13,29 @@ struct	file
 	union {
 		off_t	f_offset;	/* read/write character pointer */
 		struct chan *f_chan;	/* mpx channel pointer */
+		struct file *f_nextf;	/* free list, if f_count is 0 */
 	} f_un;
 };
 
 extern struct file file[];	/* The file table itself */
+extern struct file *ffreel;	/* head of the free list */
+
+/*
+ * Statistics, read from kmem by pstat.
+ * Entries from file[fs_hiwat] on have
+ * never been used; freed ones are reused
+ * first, so this is also the most ever
+ * open at once.
+ */
+struct	fstats
+{
+	int	fs_inuse;		/* entries in use */
+	int	fs_hiwat;		/* most in use at once */
+	long	fs_alloc;		/* entries allocated */
+	long	fs_fail;		/* allocations failed, table full */
+};
+
+extern struct fstats fstats;
 
 /* flags */
 #define	FREAD	01
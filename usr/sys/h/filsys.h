@@ -20,4 +20,38 @@ struct	filsys {
 	short  	s_n;       	/* " " */
 	char   	s_fname[6];	/* file system name */
 	char   	s_fpack[6];	/* file system pack name */
+	/* free-block bitmap; s_tfree is kept when FS_BITMAP is set */
+	short	s_flags;   	/* FS_BITMAP, FS_IMAP */
+	daddr_t	s_bmap;    	/* first block of the bitmap */
+	short	s_nbmap;   	/* blocks in the bitmap */
+	daddr_t	s_brotor;  	/* where to look with no preference */
+	/* free-inode bitmap; s_tinode is kept when FS_IMAP is set */
+	daddr_t	s_imap;    	/* first block of the inode map */
+	short	s_nimap;   	/* blocks in the inode map */
+	ino_t	s_irotor;  	/* where ialloc next looks */
 };
+
+/*
+ * With FS_BITMAP the free list is not used; instead
+ * one bit per block of the volume, set if the block
+ * is free, is kept in the s_nbmap blocks following
+ * the i-list and any inode map.  Bits for those
+ * and the bitmap itself are always clear.
+ */
+#define	FS_BITMAP	01
+#define	BMSHIFT	12		/* LOG2(bits per bitmap block) */
+#define	BMMASK	07777		/* BSIZE*8 - 1 */
+#define	BMDATA(fp)	((fp)->s_bmap + (fp)->s_nbmap)	/* first data block */
+
+/*
+ * With FS_IMAP one bit per inode number,
+ * set if the inode is free, is kept in the
+ * s_nimap blocks following the i-list, ahead
+ * of any block bitmap.  ialloc refills the
+ * super-block list from it instead of
+ * reading the i-list.
+ */
+#define	FS_IMAP	02
+#define	IMDATA(fp)	((fp)->s_imap + (fp)->s_nimap)
+#define	FSDATA(fp)	((fp)->s_flags&FS_BITMAP? BMDATA(fp): \
+			(fp)->s_flags&FS_IMAP? IMDATA(fp): (daddr_t)(fp)->s_isize)
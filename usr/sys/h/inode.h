@@ -38,16 +38,51 @@ struct	inode
 		struct {
 			daddr_t i_addr[NADDR];	/* if normal file/directory */
 			daddr_t	i_lastr;	/* last logical block read (for read-ahead) */
+			daddr_t	i_rablk;	/* last logical block read ahead */
+			short	i_rawin;	/* blocks to read ahead, up to RAMAX */
+			daddr_t	i_cbn;		/* map cache: first logical block */
+			daddr_t	i_cpbn;		/*  its device address */
+			daddr_t	i_cnext;	/*  address of the block after the run */
+			short	i_clen;		/*  blocks in the run, 0 if none */
+			char	i_clev;		/*  indirect blocks it was found through */
+		};
+		struct	{
+			struct	buf *i_pbuf[PIPSIZ/BSIZE];	/* ring, if IPIPE */
+			short	i_prd;		/* ring offset of first byte */
+			short	i_pcnt;		/* bytes in the ring */
 		};
 		struct	{
 			daddr_t	i_rdev;			/* i_addr[0] */
 			struct	group	i_group;	/*  multiplexor group file */
 		};
 	} i_un;
+	struct	inode *i_hlink;	/* hash chain on (dev, ino) */
+	struct	inode **i_hback;	/* where i_hlink is pointed at us */
+	struct	inode *i_fforw;	/* free list, if i_count is 0 */
+	struct	inode **i_fback;	/*  "  */
+	struct	inode *i_dforw;	/* dirty list, if IUPD|IACC|ICHG */
+	struct	inode **i_dback;	/*  "  */
 };
 
 
 extern struct inode inode[];	/* The inode table itself */
+extern struct inode *idirtyh;	/* inodes update is to write */
+
+/*
+ * In-core inodes are found by hashing
+ * their dev/inumber pair (iget/iget.c).
+ * Unreferenced inodes keep their identity
+ * and sit on a free list in least recently
+ * used order, so they may be reclaimed by
+ * iget without a disk read.
+ * INOHSZ must be a power of 2.
+ */
+#define	INOHSZ	64
+#define	INOHASH(dev, ino)	((((int)(dev))+(int)(ino)) & (INOHSZ-1))
+
+extern struct inode *ihash[];	/* heads of the hash chains */
+extern struct inode *ifreeh;	/* head of inode free list */
+extern struct inode **ifreet;	/* tail of inode free list */
 struct inode *mpxip;		/* mpx virtual inode */
 
 /* flags */
@@ -58,6 +93,7 @@ struct inode *mpxip;		/* mpx virtual inode */
 #define	IWANT	020		/* some process waiting on lock */
 #define	ITEXT	040		/* inode is pure text prototype */
 #define	ICHG	0100		/* inode has been changed */
+#define	IPIPE	0200		/* in-core pipe; i_addr is not kept */
 
 /* modes */
 #define	IFMT	0170000		/* type of file */
@@ -6,3 +6,21 @@ struct map
 
 struct map coremap[CMAPSIZ];	/* space for core allocation */
 struct map swapmap[SMAPSIZ];	/* space for swap allocation */
+
+/*
+ * Allocation statistics, one for each map,
+ * read from kmem by pstat.
+ */
+struct mapstat
+{
+	long	ms_alloc;		/* successful allocations */
+	long	ms_fail;		/* failed allocations */
+	long	ms_frag;		/*  of those, enough was free in pieces */
+	long	ms_lost;		/* units dropped when the map was full */
+	long	ms_free;		/* frees */
+	long	ms_merge;		/*  of those, joined to a neighbor */
+};
+
+struct mapstat mapstat[2];	/* coremap, swapmap */
+#define	MAPX(mp)	((mp) != coremap)
+#define	MAPEND(mp)	((mp)==coremap? &coremap[CMAPSIZ-1]: &swapmap[SMAPSIZ-1])
@@ -0,0 +1,41 @@
+/*
+ * The name cache remembers the result of
+ * searching a directory for a component,
+ * so that namei can avoid reading the
+ * directory again.  An entry maps a
+ * dev/directory-inumber/name triple to an
+ * inumber, or to 0 if the name is known
+ * not to be there.  Entries are chained by
+ * hash and kept in least recently used
+ * order for replacement. (nami.c)
+ */
+struct	nch
+{
+	struct	nch *nc_hlink;		/* hash chain */
+	struct	nch **nc_hback;		/* where nc_hlink is pointed at us */
+	struct	nch *nc_lforw;		/* LRU list */
+	struct	nch *nc_lback;		/*  "  */
+	dev_t	nc_dev;			/* device of directory */
+	ino_t	nc_dino;		/* inumber of directory */
+	ino_t	nc_ino;			/* inumber of name, 0 if absent */
+	char	nc_name[DIRSIZ];	/* component name */
+};
+
+/*
+ * NCHSZ must be a power of 2.
+ */
+#define	NCHSZ	32
+#define	NCHHASH(dev, dino, cp) \
+	((((int)(dev))+(int)(dino)+(cp)[0]+((cp)[1]<<2)) & (NCHSZ-1))
+
+/*
+ * Statistics, read from kmem by pstat.
+ */
+struct	nchstats
+{
+	long	ncs_hits;		/* positive entries found */
+	long	ncs_neghits;		/* negative entries found */
+	long	ncs_miss;		/* directory searched */
+	long	ncs_enter;		/* entries made */
+	long	ncs_purge;		/* entries removed by change */
+};
@@ -22,8 +22,9 @@ struct	proc {
 	short	p_size;		/* size of swappable image (clicks) */
 	caddr_t p_wchan;	/* event process is awaiting */
 	struct text *p_textp;	/* pointer to text structure */
-	struct proc *p_link;	/* linked list of running processes */
+	struct proc *p_link;	/* run queue or sleep queue link */
 	int	p_clktim;	/* time to alarm clock signal */
+	char	p_rq;		/* run queue band+1, 0 if not queued */
 };
 
 extern struct proc proc[];	/* the proc table itself */
@@ -44,6 +45,8 @@ extern struct proc proc[];	/* the proc table itself */
 #define	STRC	020		/* process is being traced */
 #define	SWTED	040		/* another tracing flag */
 #define	SULOCK	0100		/* user settable lock in core */
+#define	SVFORK	0200		/* image lent to a vfork child */
+#define	SAIO	0400		/* asynchronous raw I/O to the image */
 
 /*
  * parallel proc structure
@@ -2,21 +2,32 @@
  * tunable variables
  */
 
+#define	RAMAX	2		/* max blocks of read-ahead per file */
+#define	WBCLUST	2		/* consecutive delayed writes pushed together */
+#define	BDAGE	5		/* seconds before a delayed write is flushed */
+#define	NBTRICK	2		/* most delayed writes flushed per second */
 #define	NBUF	8		/* size of buffer cache */
+#define	NSWBUF	3		/* swap transfers queued at once */
+#define	NAIO	2		/* asynchronous raw transfers at once */
 #define	NINODE	75		/* number of in core inodes */
+#define	NITRQ	2		/* truncations queued for itrund */
 #define	NFILE	75		/* number of in core file structures */
+#define	PIPSIZ	1024		/* bytes buffered per pipe; a multiple of BSIZE */
 #define	NMOUNT	3		/* number of mountable file systems */
 #define	MAXMEM	(64*32)		/* max core per process - first # is Kw */
 #define	MAXUPRC	15		/* max processes per user */
 #define	SSIZE	20		/* initial stack size (*64 bytes) */
 #define	SINCR	20		/* increment of stack (*64 bytes) */
 #define	NOFILE	20		/* max open files per process */
+#define	NFMAP	1		/* max mapped files per process */
 #define	CANBSIZ	256		/* max size of typewriter line */
 #define	CMAPSIZ	50		/* size of core allocation area */
 #define	SMAPSIZ	50		/* size of swap allocation area */
 #define	NCALL	20		/* max simultaneous time callouts */
 #define	NPROC	50		/* max number of processes */
 #define	NTEXT	25		/* max number of pure texts */
+#define	NXCACHE	4		/* unused pure texts kept for reuse */
+#define	NNCACHE	20		/* size of namei directory name cache */
 #define	NCLIST	100		/* max total clist size */
 #define	HZ	60		/* Ticks/second of the clock */
 #define	TIMEZONE (5*60)		/* Minutes westward from Greenwich */
@@ -91,8 +102,9 @@
 #define	NICINOD	100		/* number of superblock inodes */
 #define	NICFREE	50		/* number of superblock free blocks */
 #define	INFSIZE	138		/* size of per-proc info for users */
-#define	CBSIZE	6		/* number of chars in a clist block */
-#define	CROUND	07		/* clist rounding: sizeof(int *) + CBSIZE - 1*/
+#define	CBSHIFT	3		/* log2 of clist block size, link included */
+#define	CBSIZE	((1<<CBSHIFT)-(int)sizeof(char *))	/* chars in a clist block */
+#define	CROUND	((1<<CBSHIFT)-1)	/* clist rounding: sizeof(char *) + CBSIZE - 1 */
 
 /*
  * Some macros for units conversion
@@ -5,10 +5,10 @@
  */
 char	canonb[CANBSIZ];	/* buffer for erase and kill (#@) */
 struct inode *rootdir;		/* pointer to inode of root directory */
-struct proc *runq;		/* head of linked list of running processes */
 int	cputype;		/* type of cpu =40, 45, or 70 */
 int	lbolt;			/* time of day in 60th not in time */
 time_t	time;			/* time in sec from 1970 */
+long	lticks;			/* clock ticks since boot */
 
 /*
  * Nblkdev is the number of entries
@@ -49,14 +49,17 @@ dev_t getmdev();
 daddr_t	bmap();
 struct inode *ialloc();
 struct inode *iget();
+struct inode *ifind();
 struct inode *owner();
 struct inode *maknode();
 struct inode *namei();
 struct buf *alloc();
 struct buf *getblk();
+struct buf *bhfind();
 struct buf *geteblk();
 struct buf *bread();
 struct buf *breada();
+struct buf *breadn();
 struct filsys *getfs();
 struct file *getf();
 struct file *falloc();
@@ -70,6 +73,10 @@ long	dk_numb[3];
 long	dk_wds[3];
 long	tk_nin;
 long	tk_nout;
+long	dk_qlen[3];		/* requests found queued, summed */
+long	dk_seek[3];		/* cylinders moved */
+long	dk_wait[3];		/* ticks from queueing to completion, summed */
+long	dk_nrd[3];		/* requests that were reads */
 
 /*
  * Structure of the system-entry table
@@ -13,6 +13,9 @@ struct text
 	char	x_count;	/* reference count */
 	char	x_ccount;	/* number of loaded references */
 	char	x_flag;		/* traced, written flags */
+	struct text *x_hlink;	/* hash chain, by inode */
+	struct text *x_lforw;	/* LRU list of cached texts */
+	struct text *x_lback;	/*  "  */
 };
 
 extern struct text text[];
@@ -22,3 +25,29 @@ extern struct text text[];
 #define	XLOAD	04		/* Currently being read from file */
 #define	XLOCK	010		/* Being swapped in or out */
 #define	XWANT	020		/* Wanted for swapping */
+#define	XCACHE	040		/* Unused, kept for the next exec */
+
+/*
+ * Texts in use or cached are chained by the
+ * inode of their file.  XHSZ must be a power of 2.
+ */
+#define	XHSZ	16
+#define	XHASH(ip)	(((unsigned)(ip) >> 6) & (XHSZ-1))
+
+/*
+ * Statistics, read from kmem by pstat.
+ */
+struct	xstats
+{
+	long	xs_alloc;		/* execs of pure programs */
+	long	xs_hit;			/* text found in use */
+	long	xs_chit;		/* text found cached */
+	long	xs_ccore;		/*  of which still in core */
+	long	xs_miss;		/* text read from its file */
+	long	xs_evict;		/* cached texts dropped for room */
+	long	xs_reclaim;		/* cached texts' core given up */
+	long	xs_rawx;		/* transfers by exec straight to core */
+	long	xs_rawb;		/*  blocks they moved */
+	long	xs_dldef;		/* data pages left to first touch */
+	long	xs_dlflt;		/*  of which read on a fault */
+};
@@ -1,10 +1,12 @@
 /*
  * A clist structure is the head
  * of a linked list queue of characters.
- * The characters are stored in 4-word
- * blocks containing a link and several characters.
+ * The characters are stored in blocks of
+ * 1<<CBSHIFT bytes containing a link and
+ * CBSIZE characters (param.h).
  * The routines getc and putc
- * manipulate these structures.
+ * manipulate these structures a character
+ * at a time, q_to_b and b_to_q in bulk.
  */
 struct clist
 {
@@ -90,6 +92,7 @@ struct	ttiocb {
 #define	TTHIWAT	100
 #define	TTLOWAT	50
 #define	TTYHOG	256
+#define	TTRBULK	16	/* raw input characters batched by interrupt routines */
 
 /* modes */
 #define	TANDEM	01
@@ -0,0 +1,19 @@
+/*
+ * Structure of the buffer vectors
+ * passed to readv and writev.
+ */
+struct	iovec
+{
+	caddr_t	iov_base;	/* start of buffer */
+	unsigned iov_len;	/* bytes in buffer */
+};
+
+#define	MAXIOV	16		/* max buffers in one call */
+
+/*
+ * Commands to aio.
+ */
+#define	AIOREAD		0	/* start a read, return a handle */
+#define	AIOWRITE	1	/* start a write */
+#define	AIOWAIT		2	/* wait for one, return its count */
+#define	AIOPOLL		3	/* 1 if one has finished, else 0 */
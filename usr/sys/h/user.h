@@ -52,6 +52,7 @@ struct	user
 	int	u_uisd[16];		/* prototype of segmentation descriptors */
 	struct file *u_ofile[NOFILE];	/* pointers to file structures of open files */
 	char	u_pofile[NOFILE];	/* per-process flags of open files */
+	char	u_lofile;		/* no free descriptor below this */
 	int	u_arg[5];		/* arguments to current system call */
 	unsigned u_tsize;		/* text size (clicks) */
 	unsigned u_dsize;		/* data size (clicks) */
@@ -89,6 +90,24 @@ struct	user
 	char	u_acflag;
 	short	u_fpflag;		/* unused now, will be later */
 	short	u_cmask;		/* mask for file creation */
+	long	u_ior;			/* blocks read from disk */
+	long	u_iow;			/* blocks written to disk */
+	long	u_iohit;		/* block reads found in the cache */
+	long	u_iowt;			/* ticks spent waiting for I/O */
+	struct proc *u_vfork;		/* vfork child: parent whose image is used */
+	struct buf *u_abp;		/* header for physio to start asynchronously */
+	struct	fmap {			/* files mapped by fmap */
+		struct	inode *fm_ip;	/* the file; NULL if slot free */
+		short	fm_seg;		/* segmentation register used */
+		short	fm_bno;		/* first block of the file mapped */
+		short	fm_addr;	/* core it is copied to, in clicks */
+		short	fm_size;	/* clicks mapped */
+		short	fm_len;		/* clicks filled so far */
+	} u_fmap[NFMAP];
+	struct	inode *u_dlip;		/* file of data pages exec left unread */
+	off_t	u_dloff;		/* where the data starts in it */
+	unsigned u_dlsize;		/* bytes of data in it */
+	char	u_dlpage;		/* pages left, a bit per register */
 	int	u_stack[1];
 					/* kernel stack per user
 					 * extends from u + USIZE*64
@@ -66,7 +66,7 @@ acct()
 	acctbuf.ac_uid = u.u_ruid;
 	acctbuf.ac_gid = u.u_rgid;
 	acctbuf.ac_mem = 0;
-	acctbuf.ac_io = 0;
+	acctbuf.ac_io = compress(u.u_ior + u.u_iow);
 	acctbuf.ac_tty = u.u_ttyd;
 	acctbuf.ac_flag = u.u_acflag;
 	siz = ip->i_size;
@@ -11,6 +11,29 @@
 #include "../h/user.h"
 typedef	struct fblk *FBLKP;
 
+#define	IALMON	1
+
+#ifdef	IALMON
+struct {
+	long	nalloc;		/* calls to ialloc */
+	long	nscan;		/* times the super-block list was refilled */
+	long	nblk;		/* i-list or map blocks read to refill it */
+	long	nexam;		/* inodes examined to refill it */
+} ia_info;
+#endif
+
+#define	UPDMON	1
+
+#ifdef	UPDMON
+struct {
+	long	nsync;		/* calls to update that did the work */
+	long	ninode;		/* inodes written */
+	long	nbuf;		/* delayed writes started */
+	long	nticks;		/* clock ticks spent in update */
+	long	maxticks;	/* longest update */
+} up_info;
+#endif
+
 /*
  * alloc will obtain the next available
  * free disk block from the free list of
@@ -18,21 +41,31 @@ typedef	struct fblk *FBLKP;
  * The super block has up to NICFREE remembered
  * free blocks; the last of these is read to
  * obtain NICFREE more . . .
+ * On a file system with a free-block bitmap
+ * the first free block at or after pref is
+ * taken instead; 0 means no preference.
  *
  * no space on dev x/y -- when
  * the free list is exhausted.
  */
 struct buf *
-alloc(dev)
+alloc(dev, pref)
 dev_t dev;
+daddr_t pref;
 {
 	daddr_t bno;
 	register struct filsys *fp;
 	register struct buf *bp;
+	daddr_t bmalloc();
 
 	fp = getfs(dev);
 	while(fp->s_flock)
 		sleep((caddr_t)&fp->s_flock, PINOD);
+	if(fp->s_flags & FS_BITMAP) {
+		if((bno = bmalloc(fp, dev, pref)) == 0)
+			goto nospace;
+		goto found;
+	}
 	do {
 		if(fp->s_nfree <= 0)
 			goto nospace;
@@ -58,6 +91,7 @@ dev_t dev;
 		if (fp->s_nfree <=0)
 			goto nospace;
 	}
+found:
 	bp = getblk(dev, bno);
 	clrbuf(bp);
 	fp->s_fmod = 1;
@@ -88,6 +122,10 @@ daddr_t bno;
 		sleep((caddr_t)&fp->s_flock, PINOD);
 	if (badblock(fp, bno, dev))
 		return;
+	if(fp->s_flags & FS_BITMAP) {
+		bmfree(fp, dev, bno);
+		return;
+	}
 	if(fp->s_nfree <= 0) {
 		fp->s_nfree = 1;
 		fp->s_free[0] = 0;
@@ -123,13 +161,110 @@ daddr_t bn;
 dev_t dev;
 {
 
-	if (bn < fp->s_isize || bn >= fp->s_fsize) {
+	if (bn < FSDATA(fp) || bn >= fp->s_fsize) {
 		prdev("bad block", dev);
 		return(1);
 	}
 	return(0);
 }
 
+/*
+ * Take the first free block in the bitmap
+ * at or after pref, or after the rotor if
+ * there is no useful preference, wrapping
+ * round the volume once.
+ * The bitmap blocks are read through the
+ * cache and written back with bdwrite.
+ * Returns 0 if the volume is full.
+ */
+daddr_t
+bmalloc(fp, dev, pref)
+register struct filsys *fp;
+dev_t dev;
+daddr_t pref;
+{
+	register char *cp;
+	register i;
+	struct buf *bp;
+	daddr_t bno, lim;
+	int n, rot;
+
+	rot = 0;
+	if(pref < BMDATA(fp) || pref >= fp->s_fsize) {
+		rot++;
+		pref = fp->s_brotor;
+		if(pref < BMDATA(fp) || pref >= fp->s_fsize)
+			pref = BMDATA(fp);
+	}
+	fp->s_flock++;
+	bno = pref;
+	/*
+	 * the starting map block is
+	 * visited twice, for the wrap
+	 */
+	for(n = 0; n <= fp->s_nbmap; n++) {
+		bp = bread(dev, fp->s_bmap + (bno>>BMSHIFT));
+		if(bp->b_flags & B_ERROR) {
+			brelse(bp);
+			break;
+		}
+		cp = bp->b_un.b_addr;
+		lim = ((bno>>BMSHIFT) + 1) << BMSHIFT;
+		if(lim > fp->s_fsize)
+			lim = fp->s_fsize;
+		for(; bno < lim; bno++) {
+			i = (int)bno & BMMASK;
+			if((i&07) == 0 && cp[i>>3] == 0) {
+				bno += 7;
+				continue;
+			}
+			if(cp[i>>3] & (1<<(i&07))) {
+				cp[i>>3] &= ~(1<<(i&07));
+				bdwrite(bp);
+				if(rot)
+					fp->s_brotor = bno+1;
+				fp->s_tfree--;
+				goto out;
+			}
+		}
+		brelse(bp);
+		if(bno >= fp->s_fsize)
+			bno = BMDATA(fp);
+	}
+	bno = 0;
+out:
+	fp->s_flock = 0;
+	wakeup((caddr_t)&fp->s_flock);
+	return(bno);
+}
+
+/*
+ * Mark a block free in the bitmap.
+ */
+bmfree(fp, dev, bno)
+register struct filsys *fp;
+dev_t dev;
+daddr_t bno;
+{
+	register i;
+	register struct buf *bp;
+
+	fp->s_flock++;
+	bp = bread(dev, fp->s_bmap + (bno>>BMSHIFT));
+	if((bp->b_flags & B_ERROR) == 0) {
+		i = (int)bno & BMMASK;
+		if(bp->b_un.b_addr[i>>3] & (1<<(i&07)))
+			prdev("freeing free block", dev);
+		else
+			fp->s_tfree++;
+		bp->b_un.b_addr[i>>3] |= 1<<(i&07);
+		bdwrite(bp);
+	} else
+		brelse(bp);
+	fp->s_flock = 0;
+	wakeup((caddr_t)&fp->s_flock);
+}
+
 /*
  * Allocate an unused I node
  * on the specified device.
@@ -139,7 +274,9 @@ dev_t dev;
  * super block. When this runs out,
  * a linear search through the
  * I list is instituted to pick
- * up NICINOD more.
+ * up NICINOD more, or on a file
+ * system with an inode map, a
+ * search of the map.
  */
 struct inode *
 ialloc(dev)
@@ -156,6 +293,9 @@ dev_t dev;
 	fp = getfs(dev);
 	while(fp->s_ilock)
 		sleep((caddr_t)&fp->s_ilock, PINOD);
+#ifdef	IALMON
+	ia_info.nalloc++;
+#endif
 loop:
 	if(fp->s_ninode > 0) {
 		ino = fp->s_inode[--fp->s_ninode];
@@ -167,6 +307,8 @@ loop:
 		if(ip->i_mode == 0) {
 			for (i=0; i<NADDR; i++)
 				ip->i_un.i_addr[i] = 0;
+			if(fp->s_flags & FS_IMAP)
+				imset(fp, dev, ino, 0);
 			fp->s_fmod = 1;
 			return(ip);
 		}
@@ -174,13 +316,25 @@ loop:
 		 * Inode was allocated after all.
 		 * Look some more.
 		 */
+		if(fp->s_flags & FS_IMAP)
+			imset(fp, dev, ino, 0);
 		iput(ip);
 		goto loop;
 	}
 	fp->s_ilock++;
+#ifdef	IALMON
+	ia_info.nscan++;
+#endif
+	if(fp->s_flags & FS_IMAP) {
+		imscan(fp, dev);
+		goto done;
+	}
 	ino = 1;
 	for(adr = SUPERB+1; adr < fp->s_isize; adr++) {
 		bp = bread(dev, adr);
+#ifdef	IALMON
+		ia_info.nblk++;
+#endif
 		if (bp->b_flags & B_ERROR) {
 			brelse(bp);
 			ino += INOPB;
@@ -188,10 +342,12 @@ loop:
 		}
 		dp = bp->b_un.b_dino;
 		for(i=0; i<INOPB; i++) {
+#ifdef	IALMON
+			ia_info.nexam++;
+#endif
 			if(dp->di_mode != 0)
 				goto cont;
-			for(ip = &inode[0]; ip < &inode[NINODE]; ip++)
-			if(dev==ip->i_dev && ino==ip->i_number)
+			if(ifind(dev, ino) != NULL)
 				goto cont;
 			fp->s_inode[fp->s_ninode++] = ino;
 			if(fp->s_ninode >= NICINOD)
@@ -204,6 +360,7 @@ loop:
 		if(fp->s_ninode >= NICINOD)
 			break;
 	}
+done:
 	fp->s_ilock = 0;
 	wakeup((caddr_t)&fp->s_ilock);
 	if(fp->s_ninode > 0)
@@ -218,7 +375,8 @@ loop:
  * on the specified device.
  * The algorithm stores up
  * to NICINOD I nodes in the super
- * block and throws away any more.
+ * block and throws away any more;
+ * an inode map records them all.
  */
 ifree(dev, ino)
 dev_t dev;
@@ -227,6 +385,8 @@ ino_t ino;
 	register struct filsys *fp;
 
 	fp = getfs(dev);
+	if(fp->s_flags & FS_IMAP)
+		imset(fp, dev, ino, 1);
 	if(fp->s_ilock)
 		return;
 	if(fp->s_ninode >= NICINOD)
@@ -235,6 +395,105 @@ ino_t ino;
 	fp->s_fmod = 1;
 }
 
+/*
+ * Refill the super-block list of free
+ * inodes from the inode map, going on
+ * from the rotor and wrapping round once.
+ * Inodes in use in core are passed over;
+ * those only cached there are free.
+ */
+imscan(fp, dev)
+register struct filsys *fp;
+dev_t dev;
+{
+	register char *cp;
+	register i;
+	struct buf *bp;
+	struct inode *ip;
+	daddr_t mb;
+	ino_t ino, mino;
+	unsigned n;
+
+	mino = (fp->s_isize-2) * INOPB;
+	ino = fp->s_irotor;
+	if(ino < ROOTINO || ino > mino)
+		ino = ROOTINO;
+	bp = NULL;
+	for(n = 0; n < mino; n++, ino++) {
+		if(ino > mino)
+			ino = ROOTINO;
+		mb = fp->s_imap + (ino>>BMSHIFT);
+		if(bp == NULL || bp->b_blkno != mb) {
+			if(bp != NULL)
+				brelse(bp);
+			bp = bread(dev, mb);
+#ifdef	IALMON
+			ia_info.nblk++;
+#endif
+			if(bp->b_flags & B_ERROR)
+				break;
+			cp = bp->b_un.b_addr;
+		}
+		i = ino & BMMASK;
+		if((i&07) == 0 && cp[i>>3] == 0) {
+			ino += 7;
+			n += 7;
+			continue;
+		}
+#ifdef	IALMON
+		ia_info.nexam++;
+#endif
+		if((cp[i>>3] & (1<<(i&07))) == 0)
+			continue;
+		if((ip = ifind(dev, ino)) != NULL && ip->i_count)
+			continue;
+		fp->s_inode[fp->s_ninode++] = ino;
+		if(fp->s_ninode >= NICINOD) {
+			ino++;
+			break;
+		}
+	}
+	if(bp != NULL)
+		brelse(bp);
+	fp->s_irotor = ino;
+}
+
+/*
+ * Mark inode ino free (f set) or in
+ * use in the inode map, and keep the
+ * count of free inodes.
+ */
+imset(fp, dev, ino, f)
+register struct filsys *fp;
+dev_t dev;
+ino_t ino;
+{
+	register char *cp;
+	register m;
+	struct buf *bp;
+
+	bp = bread(dev, fp->s_imap + (ino>>BMSHIFT));
+	if(bp->b_flags & B_ERROR) {
+		brelse(bp);
+		return;
+	}
+	cp = &bp->b_un.b_addr[(ino&BMMASK) >> 3];
+	m = 1 << (ino&07);
+	if(f) {
+		if(*cp & m)
+			prdev("freeing free inode", dev);
+		else
+			fp->s_tinode++;
+		*cp |= m;
+	} else {
+		if(*cp & m)
+			fp->s_tinode--;
+		*cp &= ~m;
+	}
+	bdwrite(bp);
+	fp->s_fmod = 1;
+}
+
 /*
  * getfs maps a device number into
  * a pointer to the incore super
@@ -282,6 +541,11 @@ dev_t dev;
  * modified nodes; and it goes through
  * the mount table to initiate modified
  * super blocks.
+ * Only the inodes and buffers on the
+ * dirty lists are looked at.  The list of
+ * inodes is searched again after each one
+ * is written, since it may have changed
+ * meanwhile; locked ones are passed over.
  */
 update()
 {
@@ -289,10 +553,17 @@ update()
 	register struct mount *mp;
 	register struct buf *bp;
 	struct filsys *fp;
+	int n;
+#ifdef	UPDMON
+	long t;
+#endif
 
 	if(updlock)
 		return;
 	updlock++;
+#ifdef	UPDMON
+	t = lticks;
+#endif
 	for(mp = &mount[0]; mp < &mount[NMOUNT]; mp++)
 		if(mp->m_bufp != NULL) {
 			fp = mp->m_bufp->b_un.b_filsys;
@@ -307,13 +578,27 @@ update()
 			bcopy((caddr_t)fp, bp->b_un.b_addr, BSIZE);
 			bwrite(bp);
 		}
-	for(ip = &inode[0]; ip < &inode[NINODE]; ip++)
+	n = 0;
+loop:
+	for(ip = idirtyh; ip != NULL && n < NINODE; ip = ip->i_dforw)
 		if((ip->i_flag&ILOCK)==0 && ip->i_count) {
 			ip->i_flag |= ILOCK;
 			ip->i_count++;
 			iupdat(ip, &time, &time);
 			iput(ip);
+			n++;
+			goto loop;
 		}
 	updlock = 0;
+#ifdef	UPDMON
+	up_info.ninode += n;
+	up_info.nbuf += bflush(NODEV);
+	t = lticks - t;
+	up_info.nsync++;
+	up_info.nticks += t;
+	if(t > up_info.maxticks)
+		up_info.maxticks = t;
+#else
 	bflush(NODEV);
+#endif
 }
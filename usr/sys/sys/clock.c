@@ -9,6 +9,13 @@
 
 #define	SCHMAG	8/10
 
+struct	callo	*calwheel[CWHEEL];
+struct	callo	*calfree;	/* unused entries */
+int	calused;		/* entries ever used */
+int	ncallo;			/* calls pending */
+int	calticks;		/* tick the hand is at */
+int	calpend;		/* ticks the hand has still to move */
+
 /*
  * clock is called straight from
  * the real time clock interrupt.
@@ -29,9 +36,11 @@ clock(dev, sp, r1, nps, r0, pc, ps)
 dev_t dev;
 caddr_t pc;
 {
-	register struct callo *p1, *p2;
+	register struct callo *p1, **p2;
 	register struct proc *pp;
 	int a;
+	int (*fn)();
+	caddr_t arg;
 	extern caddr_t waitloc;
 
 	/*
@@ -48,15 +57,12 @@ caddr_t pc;
 	/*
 	 * callouts
 	 * if none, just continue
-	 * else update first non-zero time
+	 * else count the tick for the hand
 	 */
 
-	if(callout[0].c_func == NULL)
+	if(ncallo == 0)
 		goto out;
-	p2 = &callout[0];
-	while(p2->c_time<=0 && p2->c_func!=NULL)
-		p2++;
-	p2->c_time--;
+	calpend++;
 
 	/*
 	 * if ps is high, just return
@@ -66,22 +72,35 @@ caddr_t pc;
 
 	/*
 	 * callout
+	 * move the hand over the ticks counted,
+	 * making the calls due at each slot.
+	 * The lists are changed at spl7, as
+	 * timeout may be called from any interrupt.
 	 */
 
 	spl5();
-	if(callout[0].c_time <= 0) {
-		p1 = &callout[0];
-		while(p1->c_func != 0 && p1->c_time <= 0) {
-			(*p1->c_func)(p1->c_arg);
-			p1++;
-		}
-		p2 = &callout[0];
-		while(p2->c_func = p1->c_func) {
-			p2->c_time = p1->c_time;
-			p2->c_arg = p1->c_arg;
-			p1++;
-			p2++;
+	while(calpend) {
+		spl7();
+		calpend--;
+		calticks++;
+		for(;;) {
+			spl7();
+			p2 = &calwheel[calticks & (CWHEEL-1)];
+			while((p1 = *p2) != NULL && p1->c_time - calticks > 0)
+				p2 = &p1->c_next;
+			if(p1 == NULL)
+				break;
+			*p2 = p1->c_next;
+			fn = p1->c_func;
+			arg = p1->c_arg;
+			p1->c_func = NULL;
+			p1->c_next = calfree;
+			calfree = p1;
+			ncallo--;
+			spl5();
+			(*fn)(arg);
 		}
+		spl5();
 	}
 
 	/*
@@ -103,6 +122,7 @@ out:
 		u.u_stime++;
 	}
 	dk_time[a] += 1;
+	lticks++;
 	pp = u.u_procp;
 	if(++pp->p_cpu == 0)
 		pp->p_cpu--;
@@ -140,13 +160,11 @@ out:
 /*
  * timeout is called to arrange that
  * fun(arg) is called in tim/HZ seconds.
- * An entry is sorted into the callout
- * structure. The time in each structure
- * entry is the number of HZ's more
- * than the previous entry.
- * In this way, decrementing the
- * first entry has the effect of
- * updating all entries.
+ * An entry is taken from the free list
+ * and hung on the wheel slot for the tick
+ * it is due, counted from where the hand
+ * will be once it has caught up with the clock.
+ * Times must be less than 32768 ticks.
  *
  * The panic is there because there is nothing
  * intelligent to be done if an entry won't fit.
@@ -155,31 +173,55 @@ timeout(fun, arg, tim)
 int (*fun)();
 caddr_t arg;
 {
-	register struct callo *p1, *p2;
-	register int t;
+	register struct callo *p1, **p2;
 	int s;
 
-	t = tim;
-	p1 = &callout[0];
+	if(tim <= 0)
+		tim = 1;
 	s = spl7();
-	while(p1->c_func != 0 && p1->c_time <= t) {
-		t -= p1->c_time;
-		p1++;
-	}
-	if (p1 >= &callout[NCALL-1])
+	if((p1 = calfree) != NULL)
+		calfree = p1->c_next;
+	else if(calused < NCALL)
+		p1 = &callout[calused++];
+	else
 		panic("Timeout table overflow");
-	p1->c_time -= t;
-	p2 = p1;
-	while(p2->c_func != 0)
-		p2++;
-	while(p2 >= p1) {
-		(p2+1)->c_time = p2->c_time;
-		(p2+1)->c_func = p2->c_func;
-		(p2+1)->c_arg = p2->c_arg;
-		p2--;
-	}
-	p1->c_time = t;
+	p1->c_time = calticks + calpend + tim;
 	p1->c_func = fun;
 	p1->c_arg = arg;
+	p2 = &calwheel[p1->c_time & (CWHEEL-1)];
+	p1->c_next = *p2;
+	*p2 = p1;
+	ncallo++;
+	splx(s);
+}
+
+/*
+ * untimeout cancels a call of fun(arg)
+ * arranged by timeout.  Returns 1 if one
+ * was pending, 0 if none was (perhaps it
+ * has been made already).
+ */
+untimeout(fun, arg)
+int (*fun)();
+caddr_t arg;
+{
+	register struct callo *p1, **p2;
+	int s;
+
+	s = spl7();
+	for(p1 = &callout[0]; p1 < &callout[calused]; p1++)
+		if(p1->c_func == fun && p1->c_arg == arg) {
+			p2 = &calwheel[p1->c_time & (CWHEEL-1)];
+			while(*p2 != p1)
+				p2 = &(*p2)->c_next;
+			*p2 = p1->c_next;
+			p1->c_func = NULL;
+			p1->c_next = calfree;
+			calfree = p1;
+			ncallo--;
+			splx(s);
+			return(1);
+		}
 	splx(s);
+	return(0);
 }
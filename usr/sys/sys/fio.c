@@ -9,6 +9,9 @@
 #include "../h/reg.h"
 #include "../h/acct.h"
 
+struct	file	*ffreel;
+struct	fstats	fstats;
+
 /*
  * Convert a user supplied
  * file descriptor into a pointer
@@ -64,11 +67,13 @@ register struct file *fp;
 	mode = ip->i_mode;
 
 	plock(ip);
-	fp->f_count = 0;
+	ffree(fp);
 	if(flag & FPIPE) {
 		ip->i_mode &= ~(IREAD|IWRITE);
 		wakeup((caddr_t)ip+1);
 		wakeup((caddr_t)ip+2);
+		if(ip->i_count == 1)
+			pfree(ip);
 	}
 	iput(ip);
 
@@ -88,7 +93,7 @@ register struct file *fp;
 	}
 
 	if ((flag & FMP) == 0)
-		for(fp=file; fp < &file[NFILE]; fp++)
+		for(fp=file; fp < &file[fstats.fs_hiwat]; fp++)
 			if (fp->f_count && fp->f_inode==ip)
 				return;
 	(*cfunc)(dev, flag, cp);
@@ -213,22 +218,38 @@ suser()
 }
 
 /*
- * Allocate a user file descriptor.
+ * Allocate a user file descriptor,
+ * the lowest free one.  The search
+ * starts at u_lofile, below which
+ * all are known to be in use.
  */
 ufalloc()
 {
 	register i;
 
-	for(i=0; i<NOFILE; i++)
+	for(i=u.u_lofile; i<NOFILE; i++)
 		if(u.u_ofile[i] == NULL) {
 			u.u_r.r_val1 = i;
 			u.u_pofile[i] = 0;
+			u.u_lofile = i;
 			return(i);
 		}
+	u.u_lofile = NOFILE;
 	u.u_error = EMFILE;
 	return(-1);
 }
 
+/*
+ * Release user file descriptor i.
+ */
+ufree(i)
+{
+
+	u.u_ofile[i] = NULL;
+	if(i < u.u_lofile)
+		u.u_lofile = i;
+}
+
 /*
  * Allocate a user file descriptor
  * and a file structure.
@@ -247,14 +268,34 @@ falloc()
 	i = ufalloc();
 	if(i < 0)
 		return(NULL);
-	for(fp = &file[0]; fp < &file[NFILE]; fp++)
-		if(fp->f_count == 0) {
-			u.u_ofile[i] = fp;
-			fp->f_count++;
-			fp->f_un.f_offset = 0;
-			return(fp);
-		}
-	printf("no file\n");
-	u.u_error = ENFILE;
-	return(NULL);
+	if((fp = ffreel) != NULL)
+		ffreel = fp->f_un.f_nextf;
+	else if(fstats.fs_hiwat < NFILE)
+		fp = &file[fstats.fs_hiwat++];
+	else {
+		fstats.fs_fail++;
+		printf("no file\n");
+		u.u_error = ENFILE;
+		return(NULL);
+	}
+	fstats.fs_alloc++;
+	fstats.fs_inuse++;
+	u.u_ofile[i] = fp;
+	fp->f_count++;
+	fp->f_un.f_offset = 0;
+	return(fp);
+}
+
+/*
+ * Put a file structure whose last
+ * reference has gone on the free list.
+ */
+ffree(fp)
+register struct file *fp;
+{
+
+	fp->f_count = 0;
+	fp->f_un.f_nextf = ffreel;
+	ffreel = fp;
+	fstats.fs_inuse--;
 }
@@ -9,6 +9,54 @@
 #include "../h/conf.h"
 #include "../h/buf.h"
 
+#define	INOMON	1
+
+#ifdef	INOMON
+struct {
+	long	nget;		/* calls to iget */
+	long	nhit;		/* found active in core */
+	long	nrecl;		/* found on the free list */
+	long	nmiss;		/* read from disk */
+	long	nprobe;		/* inodes examined on hash chains */
+} ino_info;
+#endif
+
+struct	inode	*ihash[INOHSZ];
+
+/*
+ * Truncations handed to itrund: the block
+ * addresses taken from a file's inode, so
+ * that the inode may be released at once.
+ * An entry is free if tq_ino is 0.
+ */
+struct itrq {
+	dev_t	tq_dev;
+	ino_t	tq_ino;
+	daddr_t	tq_addr[NADDR];
+} itrq[NITRQ];
+int	nitrq;
+struct	inode	*ifreeh;
+struct	inode	**ifreet;
+struct	inode	*idirtyh;
+struct	inode	**idirtyt;
+
+/*
+ * Initialize the inode hash chains
+ * and put every inode on the free list.
+ * Called from main before the root is
+ * read in.
+ */
+ihinit()
+{
+	register struct inode *ip;
+
+	ifreeh = NULL;
+	ifreet = &ifreeh;
+	idirtyt = &idirtyh;
+	for(ip = &inode[0]; ip < &inode[NINODE]; ip++)
+		ifput(ip);
+}
+
 /*
  * Look up an inode by device,inumber.
  * If it is in core (in the inode structure),
@@ -33,13 +81,17 @@ ino_t ino;
 {
 	register struct inode *ip;
 	register struct mount *mp;
-	register struct inode *oip;
 	register struct buf *bp;
 	register struct dinode *dp;
 
 loop:
-	oip = NULL;
-	for(ip = &inode[0]; ip < &inode[NINODE]; ip++) {
+#ifdef	INOMON
+	ino_info.nget++;
+#endif
+	for(ip = ihash[INOHASH(dev, ino)]; ip != NULL; ip = ip->i_hlink) {
+#ifdef	INOMON
+		ino_info.nprobe++;
+#endif
 		if(ino == ip->i_number && dev == ip->i_dev) {
 			if((ip->i_flag&ILOCK) != 0) {
 				ip->i_flag |= IWANT;
@@ -55,30 +107,47 @@ loop:
 				}
 				panic("no imt");
 			}
+			if(ip->i_count == 0) {
+				ifrem(ip);
+#ifdef	INOMON
+				ino_info.nrecl++;
+			} else {
+				ino_info.nhit++;
+#endif
+			}
 			ip->i_count++;
 			ip->i_flag |= ILOCK;
 			return(ip);
 		}
-		if(oip==NULL && ip->i_count==0)
-			oip = ip;
 	}
-	ip = oip;
+	ip = ifreeh;
 	if(ip == NULL) {
 		printf("Inode table overflow\n");
 		u.u_error = ENFILE;
 		return(NULL);
 	}
+#ifdef	INOMON
+	ino_info.nmiss++;
+#endif
+	ifrem(ip);
+	iunhash(ip);
 	ip->i_dev = dev;
 	ip->i_number = ino;
+	ihashin(ip);
 	ip->i_flag = ILOCK;
 	ip->i_count++;
 	ip->i_un.i_lastr = 0;
+	ip->i_un.i_rablk = 0;
+	ip->i_un.i_rawin = 0;
+	ip->i_un.i_clen = 0;
 	bp = bread(dev, itod(ino));
 	/*
 	 * Check I/O errors
 	 */
 	if((bp->b_flags&B_ERROR) != 0) {
 		brelse(bp);
+		ip->i_mode = 0;
+		ip->i_nlink = 1;
 		iput(ip);
 		return(NULL);
 	}
@@ -126,20 +195,182 @@ register struct inode *ip;
 	if(ip->i_count == 1) {
 		ip->i_flag |= ILOCK;
 		if(ip->i_nlink <= 0) {
+			if((ip->i_mode&IFMT) == IFDIR)
+				ncinval(ip->i_dev, ip->i_number);
 			itrunc(ip);
 			ip->i_mode = 0;
-			ip->i_flag |= IUPD|ICHG;
+			imark(ip, IUPD|ICHG);
 			ifree(ip->i_dev, ip->i_number);
 		}
 		iupdat(ip, &time, &time);
 		prele(ip);
 		ip->i_flag = 0;
-		ip->i_number = 0;
+		if(ip->i_mode == 0) {
+			iunhash(ip);
+			ip->i_number = 0;
+		}
+		ifput(ip);
 	}
 	ip->i_count--;
 	prele(ip);
 }
 
+/*
+ * Find an in-core inode by dev/inumber
+ * without taking a reference to it.
+ */
+struct inode *
+ifind(dev, ino)
+dev_t dev;
+ino_t ino;
+{
+	register struct inode *ip;
+
+	for(ip = ihash[INOHASH(dev, ino)]; ip != NULL; ip = ip->i_hlink)
+		if(ino == ip->i_number && dev == ip->i_dev)
+			return(ip);
+	return(NULL);
+}
+
+/*
+ * Enter an inode on the hash chain
+ * for its dev/inumber.
+ */
+ihashin(ip)
+register struct inode *ip;
+{
+	register struct inode **hp;
+
+	hp = &ihash[INOHASH(ip->i_dev, ip->i_number)];
+	if((ip->i_hlink = *hp) != NULL)
+		(*hp)->i_hback = &ip->i_hlink;
+	ip->i_hback = hp;
+	*hp = ip;
+}
+
+/*
+ * Take an inode off its hash chain.
+ */
+iunhash(ip)
+register struct inode *ip;
+{
+
+	if(ip->i_hback == NULL)
+		return;
+	if((*ip->i_hback = ip->i_hlink) != NULL)
+		ip->i_hlink->i_hback = ip->i_hback;
+	ip->i_hlink = NULL;
+	ip->i_hback = NULL;
+}
+
+/*
+ * Put an unreferenced inode at the tail of the
+ * free list; those without an identity go
+ * to the head, to be reused first.
+ */
+ifput(ip)
+register struct inode *ip;
+{
+
+	if(ip->i_number == 0) {
+		if((ip->i_fforw = ifreeh) == NULL)
+			ifreet = &ip->i_fforw;
+		else
+			ifreeh->i_fback = &ip->i_fforw;
+		ifreeh = ip;
+		ip->i_fback = &ifreeh;
+		return;
+	}
+	ip->i_fforw = NULL;
+	ip->i_fback = ifreet;
+	*ifreet = ip;
+	ifreet = &ip->i_fforw;
+}
+
+/*
+ * Take an inode off the free list.
+ */
+ifrem(ip)
+register struct inode *ip;
+{
+
+	if(ip->i_fback == NULL)
+		return;
+	if(ip->i_fforw != NULL)
+		ip->i_fforw->i_fback = ip->i_fback;
+	else
+		ifreet = ip->i_fback;
+	*ip->i_fback = ip->i_fforw;
+	ip->i_fforw = NULL;
+	ip->i_fback = NULL;
+}
+
+/*
+ * Forget all unreferenced inodes
+ * cached for a device (from umount).
+ * Returns 1 if any inode of the device
+ * is still in use, or a truncation on
+ * it is still queued for itrund.
+ */
+iflush(dev)
+dev_t dev;
+{
+	register struct inode *ip;
+	register struct itrq *tp;
+
+	for(ip = &inode[0]; ip < &inode[NINODE]; ip++)
+		if(ip->i_dev == dev && ip->i_count != 0)
+			return(1);
+	for(tp = &itrq[0]; tp < &itrq[NITRQ]; tp++)
+		if(tp->tq_ino != 0 && tp->tq_dev == dev)
+			return(1);
+	for(ip = &inode[0]; ip < &inode[NINODE]; ip++)
+		if(ip->i_dev == dev && ip->i_number != 0) {
+			iunhash(ip);
+			ifrem(ip);
+			ip->i_number = 0;
+			ifput(ip);
+		}
+	return(0);
+}
+
+/*
+ * Set flags in an inode.  If they call
+ * for it to be written, it goes on the
+ * dirty list for update, unless it is
+ * there already.
+ */
+imark(ip, flag)
+register struct inode *ip;
+{
+
+	ip->i_flag |= flag;
+	if((flag&(IUPD|IACC|ICHG)) && ip->i_dback == NULL) {
+		ip->i_dforw = NULL;
+		ip->i_dback = idirtyt;
+		*idirtyt = ip;
+		idirtyt = &ip->i_dforw;
+	}
+}
+
+/*
+ * Take an inode off the dirty list.
+ */
+idrem(ip)
+register struct inode *ip;
+{
+
+	if(ip->i_dback == NULL)
+		return;
+	if(ip->i_dforw != NULL)
+		ip->i_dforw->i_dback = ip->i_dback;
+	else
+		idirtyt = ip->i_dback;
+	*ip->i_dback = ip->i_dforw;
+	ip->i_dforw = NULL;
+	ip->i_dback = NULL;
+}
+
 /*
  * Check accessed and update flags on
  * an inode structure.
@@ -156,6 +387,7 @@ time_t *ta, *tm;
 	char *p2;
 	int i;
 
+	idrem(ip);
 	if((ip->i_flag&(IUPD|IACC|ICHG)) != 0) {
 		if(getfs(ip->i_dev)->s_ronly)
 			return;
@@ -173,6 +405,7 @@ time_t *ta, *tm;
 		dp->di_size = ip->i_size;
 		p1 = (char *)dp->di_addr;
 		p2 = (char *)ip->i_un.i_addr;
+		if((ip->i_flag&IPIPE) == 0)
 		for(i=0; i<NADDR; i++) {
 			*p1++ = *p2++;
 			if(*p2++ != 0 && (ip->i_mode&IFMT)!=IFMPC
@@ -195,6 +428,9 @@ time_t *ta, *tm;
 /*
  * Free all the disk blocks associated
  * with the specified inode structure.
+ * A file with indirect blocks is handed
+ * to itrund, if there is room, so that
+ * the caller need not wait for them.
  * The blocks of the file are removed
  * in reverse order. This FILO
  * algorithm will tend to maintain
@@ -205,18 +441,99 @@ itrunc(ip)
 register struct inode *ip;
 {
 	register i;
-	dev_t dev;
-	daddr_t bn;
+	register struct itrq *tp;
 
 	i = ip->i_mode & IFMT;
 	if (i!=IFREG && i!=IFDIR)
 		return;
-	dev = ip->i_dev;
+	ip->i_un.i_clen = 0;
+	if(nitrq < NITRQ && (ip->i_un.i_addr[NADDR-3] ||
+	   ip->i_un.i_addr[NADDR-2] || ip->i_un.i_addr[NADDR-1])) {
+		for(tp = &itrq[0]; tp->tq_ino != 0; tp++)
+			;
+		tp->tq_dev = ip->i_dev;
+		tp->tq_ino = ip->i_number;
+		for(i=0; i<NADDR; i++) {
+			tp->tq_addr[i] = ip->i_un.i_addr[i];
+			ip->i_un.i_addr[i] = (daddr_t)0;
+		}
+		nitrq++;
+		wakeup((caddr_t)itrq);
+	} else
+		ifreeb(ip->i_dev, ip->i_un.i_addr);
+	ip->i_size = 0;
+	imark(ip, ICHG|IUPD);
+	iupdat(ip, &time, &time);
+}
+
+/*
+ * The truncation daemon, run as a system
+ * process started by main.  It frees the
+ * blocks of the files queued by itrunc.
+ * The inode, cleared by itrunc, is first
+ * forced to the disk, so that after a crash
+ * no file still claims blocks given out
+ * again; blocks not yet freed are only lost,
+ * and icheck -s recovers them.
+ */
+itrund()
+{
+	register struct itrq *tp;
+	register struct buf *bp;
+
+	for(;;) {
+		for(tp = &itrq[0]; tp < &itrq[NITRQ]; tp++)
+			if(tp->tq_ino != 0)
+				break;
+		if(tp >= &itrq[NITRQ]) {
+			sleep((caddr_t)itrq, PRIBIO);
+			continue;
+		}
+		bp = bread(tp->tq_dev, itod(tp->tq_ino));
+		if(bp->b_flags & B_DELWRI)
+			bwrite(bp);
+		else
+			brelse(bp);
+		ifreeb(tp->tq_dev, tp->tq_addr);
+		tp->tq_ino = 0;
+		nitrq--;
+		wakeup((caddr_t)&nitrq);
+	}
+}
+
+/*
+ * Wait for itrund to finish the
+ * truncations queued on dev (from umount).
+ */
+itrwait(dev)
+dev_t dev;
+{
+	register struct itrq *tp;
+
+loop:
+	for(tp = &itrq[0]; tp < &itrq[NITRQ]; tp++)
+		if(tp->tq_ino != 0 && tp->tq_dev == dev) {
+			sleep((caddr_t)&nitrq, PRIBIO);
+			goto loop;
+		}
+}
+
+/*
+ * Free the blocks of a file whose
+ * addresses are in addr, clearing them.
+ */
+ifreeb(dev, addr)
+dev_t dev;
+daddr_t *addr;
+{
+	register i;
+	daddr_t bn;
+
 	for(i=NADDR-1; i>=0; i--) {
-		bn = ip->i_un.i_addr[i];
+		bn = addr[i];
 		if(bn == (daddr_t)0)
 			continue;
-		ip->i_un.i_addr[i] = (daddr_t)0;
+		addr[i] = (daddr_t)0;
 		switch(i) {
 
 		default:
@@ -235,8 +552,6 @@ register struct inode *ip;
 			tloop(dev, bn, 1, 1);
 		}
 	}
-	ip->i_size = 0;
-	ip->i_flag |= ICHG|IUPD;
 }
 
 tloop(dev, bn, f1, f2)
@@ -257,6 +572,8 @@ daddr_t bn;
 				return;
 			}
 			bap = bp->b_un.b_daddr;
+			if(f1 == 0)
+				ibsort(bap);
 		}
 		nb = bap[i];
 		if(nb == (daddr_t)0)
@@ -273,6 +590,29 @@ daddr_t bn;
 	free(dev, bn);
 }
 
+/*
+ * Sort the addresses in an indirect
+ * block, which is being freed, into
+ * ascending order, so that tloop frees
+ * the highest first and the free list
+ * gives them out again in order.
+ * They are usually nearly in order
+ * already, which suits insertion.
+ */
+ibsort(bap)
+register daddr_t *bap;
+{
+	register i, j;
+	daddr_t t;
+
+	for(i=1; i<NINDIR; i++) {
+		t = bap[i];
+		for(j=i; j>0 && bap[j-1] > t; j--)
+			bap[j] = bap[j-1];
+		bap[j] = t;
+	}
+}
+
 /*
  * Make a new file.
  */
@@ -286,7 +626,7 @@ maknode(mode)
 		iput(u.u_pdir);
 		return(NULL);
 	}
-	ip->i_flag |= IACC|IUPD|ICHG;
+	imark(ip, IACC|IUPD|ICHG);
 	if((mode&IFMT) == 0)
 		mode |= IFREG;
 	ip->i_mode = mode & ~u.u_cmask;
@@ -310,6 +650,7 @@ struct inode *ip;
 		u.u_error = ENOTDIR;
 		goto out;
 	}
+	ncpurge(u.u_pdir);
 	u.u_dent.d_ino = ip->i_number;
 	bcopy((caddr_t)u.u_dbuf, (caddr_t)u.u_dent.d_name, DIRSIZ);
 	u.u_count = sizeof(struct direct);
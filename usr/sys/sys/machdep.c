@@ -9,6 +9,10 @@
 #include "../h/map.h"
 #include "../h/reg.h"
 #include "../h/buf.h"
+#include "../h/file.h"
+#include "../h/text.h"
+
+#define	FMCLUST	4		/* blocks filled per fmap fault */
 
 /*
  * Icode is the octal bootstrap
@@ -118,6 +122,338 @@ bad:
 	u.u_error = EINVAL;
 }
 
+/*
+ * fmap system call: map part of a file read-only.
+ *	fmap(fdes, segno, bno)
+ * Up to 8K of the file, from block bno on, appears
+ * at segno*8K in the data space.  It is given core
+ * of its own, which fmfault fills from the buffer
+ * cache a cluster of blocks at a time as the process
+ * reads through it.  Returns the address; fdes -1
+ * removes the mapping at segno.  The register must
+ * not be in use by the data or stack.
+ */
+fmap()
+{
+	register struct fmap *mp;
+	register struct inode *ip;
+	register i;
+	struct file *fp;
+	struct a {
+		int	fdes;
+		int	segno;
+		int	bno;
+	} *uap;
+	long n;
+
+	uap = (struct a *)u.u_ap;
+	i = uap->segno;
+	if(i < 0 || i >= 8)
+		goto bad;
+	if(uap->fdes == -1) {
+		for(mp = &u.u_fmap[0]; mp < &u.u_fmap[NFMAP]; mp++)
+			if(mp->fm_ip != NULL && mp->fm_seg == i) {
+				fmrele(mp);
+				return;
+			}
+		goto bad;
+	}
+	if((fp = getf(uap->fdes)) == NULL)
+		return;
+	if((fp->f_flag&FREAD) == 0) {
+		u.u_error = EBADF;
+		return;
+	}
+	ip = fp->f_inode;
+	if((fp->f_flag&FPIPE) || (ip->i_mode&IFMT) != IFREG)
+		goto bad;
+	if(u.u_uisd[i+8] != 0 || (!u.u_sep && u.u_uisd[i] != 0))
+		goto bad;
+	n = ip->i_size - ((long)uap->bno << BSHIFT);
+	if(uap->bno < 0 || n <= 0)
+		goto bad;
+	for(mp = &u.u_fmap[0]; mp < &u.u_fmap[NFMAP]; mp++)
+		if(mp->fm_ip == NULL)
+			break;
+	if(mp >= &u.u_fmap[NFMAP]) {
+		u.u_error = EMFILE;
+		return;
+	}
+	if(n > 8192)
+		n = 8192;
+	mp->fm_size = ((n+BMASK) >> BSHIFT) * (BSIZE/64);
+	if((mp->fm_addr = malloc(coremap, mp->fm_size)) == 0) {
+		u.u_error = ENOMEM;
+		return;
+	}
+	ip->i_count++;
+	mp->fm_ip = ip;
+	mp->fm_seg = i;
+	mp->fm_bno = uap->bno;
+	mp->fm_len = 0;
+	fmset(mp, RO);
+	u.u_r.r_val1 = i << 13;
+	return;
+
+bad:
+	u.u_error = EINVAL;
+}
+
+/*
+ * Set the segmentation register of mapping mp
+ * to show the clicks filled so far, with access
+ * acc.  With none filled, the register is reserved
+ * (ABS) but gives no access, so that the first
+ * reference faults.
+ */
+fmset(mp, acc)
+register struct fmap *mp;
+{
+	register i, d;
+
+	i = mp->fm_seg;
+	d = ABS;
+	if(mp->fm_len)
+		d = ((mp->fm_len-1)<<8) | acc|ABS;
+	u.u_uisd[i+8] = d;
+	u.u_uisa[i+8] = mp->fm_addr;
+	if(!u.u_sep) {
+		u.u_uisd[i] = d;
+		u.u_uisa[i] = mp->fm_addr;
+	}
+	sureg();
+}
+
+/*
+ * Called on a segmentation fault that
+ * did not call for the stack to grow.
+ * If it was in a mapped file's segment
+ * past what has been filled, fill the next
+ * FMCLUST blocks and return 1 so the
+ * instruction is restarted.
+ */
+fmfault()
+{
+	register struct fmap *mp;
+	register struct inode *ip;
+	register n;
+	struct buf *bp;
+	daddr_t bn, lbn;
+	long c;
+	int i, a;
+	extern int ssr[];
+
+	i = (ssr[0]>>1) & 07;
+	for(mp = &u.u_fmap[0]; mp < &u.u_fmap[NFMAP]; mp++)
+		if(mp->fm_ip != NULL && mp->fm_seg == i)
+			break;
+	if(mp >= &u.u_fmap[NFMAP] || mp->fm_len >= mp->fm_size ||
+	   (u.u_uisd[i+8]&ABS) == 0)
+		return(0);
+	ip = mp->fm_ip;
+	plock(ip);
+	for(n=0; n<FMCLUST && mp->fm_len < mp->fm_size; n++) {
+		lbn = mp->fm_bno + mp->fm_len/(BSIZE/64);
+		a = mp->fm_addr + mp->fm_len;
+		for(i=0; i<BSIZE/64; i++)
+			clearseg(a+i);
+		c = ip->i_size - (lbn << BSHIFT);
+		bn = c > 0? bmap(ip, lbn, B_READ): -1;
+		if(u.u_error)
+			break;
+		mp->fm_len += BSIZE/64;
+		if(bn < 0)
+			continue;
+		bp = bread(ip->i_dev, bn);
+		if((bp->b_flags&B_ERROR) == 0) {
+			if(c > BSIZE)
+				c = BSIZE;
+			fmset(mp, RW);
+			copyout(bp->b_un.b_addr,
+			    (caddr_t)((mp->fm_seg<<13) + ctob(mp->fm_len-BSIZE/64)),
+			    ((int)c+1) & ~1);
+		}
+		brelse(bp);
+	}
+	prele(ip);
+	u.u_error = 0;
+	fmset(mp, RO);
+	return(n > 0);
+}
+
+/*
+ * Remove mapping mp, unless a change in the
+ * size of the data or stack has overlaid its
+ * register already, and free its core and file.
+ * The file may be the one exec has locked.
+ */
+fmrele(mp)
+register struct fmap *mp;
+{
+	register i;
+
+	i = mp->fm_seg;
+	if(u.u_uisd[i+8]&ABS) {
+		u.u_uisd[i+8] = 0;
+		u.u_uisa[i+8] = 0;
+		if(!u.u_sep) {
+			u.u_uisd[i] = 0;
+			u.u_uisa[i] = 0;
+		}
+		sureg();
+	}
+	mfree(coremap, mp->fm_size, mp->fm_addr);
+	if(mp->fm_ip->i_flag&ILOCK)
+		mp->fm_ip->i_count--;
+	else {
+		plock(mp->fm_ip);
+		iput(mp->fm_ip);
+	}
+	mp->fm_ip = NULL;
+}
+
+/*
+ * Remove all the process's mappings;
+ * on exit and exec.  With fork set, as in
+ * a new child, the core and files belong to
+ * the parent and only the registers are cleared.
+ */
+fmclear(fork)
+{
+	register struct fmap *mp;
+	register i;
+
+	for(mp = &u.u_fmap[0]; mp < &u.u_fmap[NFMAP]; mp++) {
+		if(mp->fm_ip == NULL)
+			continue;
+		if(!fork) {
+			fmrele(mp);
+			continue;
+		}
+		i = mp->fm_seg;
+		if(u.u_uisd[i+8]&ABS) {
+			u.u_uisd[i+8] = 0;
+			u.u_uisa[i+8] = 0;
+			if(!u.u_sep) {
+				u.u_uisd[i] = 0;
+				u.u_uisa[i] = 0;
+			}
+		}
+		mp->fm_ip = NULL;
+	}
+	if(fork)
+		sureg();
+}
+
+/*
+ * Called by exec once the new image is set
+ * up, to leave its data, already cleared, to
+ * be read from ip a page at a time as it is
+ * first touched.  The pages' registers give
+ * no access until then.  The data is size
+ * bytes at off in the file.
+ */
+dlset(ip, off, size)
+struct inode *ip;
+off_t off;
+unsigned size;
+{
+	register i, n, p;
+
+	p = u.u_sep? 0: ctos(u.u_tsize);
+	n = ((long)size + 8191) >> 13;
+	if(n == 0)
+		return;
+	for(i = p; i < p+n; i++) {
+		u.u_dlpage |= 1<<i;
+		u.u_uisd[i+8] &= ~RW;
+		if(!u.u_sep)
+			u.u_uisd[i] &= ~RW;
+	}
+	xstats.xs_dldef += n;
+	ip->i_count++;
+	u.u_dlip = ip;
+	u.u_dloff = off;
+	u.u_dlsize = size;
+	sureg();
+}
+
+/*
+ * Read the data pages in mask m that
+ * exec left unread, and give them access.
+ * The kernel cannot fault them in itself,
+ * so all are read before a system call,
+ * a core dump or a change of size.
+ */
+dlfill(m)
+{
+	register struct inode *ip;
+	register i, p;
+	unsigned o;
+
+	ip = u.u_dlip;
+	p = u.u_sep? 0: ctos(u.u_tsize);
+	u.u_error = 0;
+	plock(ip);
+	for(i = 0; i < 8; i++) {
+		if((m & u.u_dlpage & (1<<i)) == 0)
+			continue;
+		u.u_dlpage &= ~(1<<i);
+		u.u_uisd[i+8] |= RW;
+		if(!u.u_sep)
+			u.u_uisd[i] |= RW;
+		sureg();
+		o = (unsigned)(i-p) << 13;
+		u.u_base = (caddr_t)(i << 13);
+		u.u_offset = u.u_dloff + o;
+		u.u_count = min(u.u_dlsize-o, 8192);
+		u.u_segflg = 0;
+		readx(ip);
+	}
+	if(u.u_error) {
+		psignal(u.u_procp, SIGKIL);
+		u.u_error = 0;
+	}
+	if(u.u_dlpage == 0) {
+		iput(ip);
+		u.u_dlip = NULL;
+	} else
+		prele(ip);
+}
+
+/*
+ * Called on a segmentation fault after
+ * fmfault.  If it was in a data page
+ * exec left unread, read the page and
+ * return 1 so the instruction is restarted.
+ */
+dlfault()
+{
+	register i;
+	extern int ssr[];
+
+	i = (ssr[0]>>1) & 07;
+	if((u.u_dlpage & (1<<i)) == 0)
+		return(0);
+	xstats.xs_dlflt++;
+	dlfill(1<<i);
+	return(1);
+}
+
+/*
+ * Drop the pages left unread, on exit.
+ */
+dlrele()
+{
+
+	if(u.u_dlip == NULL)
+		return;
+	plock(u.u_dlip);
+	iput(u.u_dlip);
+	u.u_dlip = NULL;
+	u.u_dlpage = 0;
+}
+
 /*
  * Determine which clock is attached, and start it.
  * panic: no clock found
@@ -23,6 +23,8 @@
  *	call all initialization routines
  *	fork - process 0 to schedule
  *	     - process 1 execute bootstrap
+ *	     - process 2 to flush delayed writes
+ *	     - process 3 to free truncated files' blocks
  *
  * loop at low address in user mode -- /etc/init
  *	cannot be executed.
@@ -51,6 +53,8 @@ main()
 	clkstart();
 	cinit();
 	binit();
+	ihinit();
+	nchinit();
 	iinit();
 	rootdir = iget(rootdev, (ino_t)ROOTINO);
 	rootdir->i_flag &= ~ILOCK;
@@ -64,7 +68,7 @@ main()
 	 * with system process
 	 */
 
-	if(newproc()) {
+	if(newproc(0)) {
 		expand(USIZE + (int)btoc(szicode));
 		estabur((unsigned)0, btoc(szicode), (unsigned)0, 0, RO);
 		copyout((caddr_t)icode, (caddr_t)0, szicode);
@@ -74,6 +78,14 @@ main()
 		 */
 		return;
 	}
+	if(newproc(0)) {
+		u.u_procp->p_flag |= SSYS;
+		bflushd();
+	}
+	if(newproc(0)) {
+		u.u_procp->p_flag |= SSYS;
+		itrund();
+	}
 	sched();
 }
 
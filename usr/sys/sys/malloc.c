@@ -10,28 +10,47 @@
  * list is terminated by a 0 size.
  * The core map unit is 64 bytes; the swap map unit
  * is 512 bytes.
- * Algorithm is first-fit.
+ * Algorithm is best-fit: the smallest free piece
+ * that will do is used, so the large pieces are
+ * left for large processes.  With maps of a few
+ * dozen pieces one pass over the sorted array
+ * is cheap, and keeping the array sorted makes
+ * joining neighbors in mfree trivial.
  */
 malloc(mp, size)
 struct map *mp;
 {
 	register unsigned int a;
-	register struct map *bp;
+	register struct map *bp, *fp;
+	long tot;
 
+	fp = NULL;
+	tot = 0;
 	for (bp=mp; bp->m_size; bp++) {
-		if (bp->m_size >= size) {
-			a = bp->m_addr;
-			bp->m_addr += size;
-			if ((bp->m_size -= size) == 0) {
-				do {
-					bp++;
-					(bp-1)->m_addr = bp->m_addr;
-				} while ((bp-1)->m_size = bp->m_size);
-			}
-			return(a);
+		tot += bp->m_size;
+		if (bp->m_size >= size &&
+		    (fp == NULL || bp->m_size < fp->m_size)) {
+			fp = bp;
+			if (bp->m_size == size)
+				break;
 		}
 	}
-	return(0);
+	if ((bp = fp) == NULL) {
+		mapstat[MAPX(mp)].ms_fail++;
+		if (tot >= size)
+			mapstat[MAPX(mp)].ms_frag++;
+		return(0);
+	}
+	mapstat[MAPX(mp)].ms_alloc++;
+	a = bp->m_addr;
+	bp->m_addr += size;
+	if ((bp->m_size -= size) == 0) {
+		do {
+			bp++;
+			(bp-1)->m_addr = bp->m_addr;
+		} while ((bp-1)->m_size = bp->m_size);
+	}
+	return(a);
 }
 
 /*
@@ -46,13 +65,16 @@ register int a;
 {
 	register struct map *bp;
 	register unsigned int t;
+	struct map *ep;
 
 	if ((bp = mp)==coremap && runin) {
 		runin = 0;
 		wakeup((caddr_t)&runin);	/* Wake scheduler when freeing core */
 	}
+	mapstat[MAPX(mp)].ms_free++;
 	for (; bp->m_addr<=a && bp->m_size!=0; bp++);
 	if (bp>mp && (bp-1)->m_addr+(bp-1)->m_size == a) {
+		mapstat[MAPX(mp)].ms_merge++;
 		(bp-1)->m_size += size;
 		if (a+size == bp->m_addr) {
 			(bp-1)->m_size += bp->m_size;
@@ -64,9 +86,22 @@ register int a;
 		}
 	} else {
 		if (a+size == bp->m_addr && bp->m_size) {
+			mapstat[MAPX(mp)].ms_merge++;
 			bp->m_addr -= size;
 			bp->m_size += size;
 		} else if (size) {
+			/*
+			 * A new piece needs an entry, and the
+			 * last entry must stay free to end the map.
+			 */
+			for (ep = bp; ep->m_size; ep++)
+				;
+			if (ep >= MAPEND(mp)) {
+				mapstat[MAPX(mp)].ms_lost += size;
+				printf("%s map full, lost %d at %u\n",
+				    mp==coremap? "core": "swap", size, a);
+				return;
+			}
 			do {
 				t = bp->m_addr;
 				bp->m_addr = a;
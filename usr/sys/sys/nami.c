@@ -5,6 +5,14 @@
 #include "../h/dir.h"
 #include "../h/user.h"
 #include "../h/buf.h"
+#include "../h/nch.h"
+
+struct	nch	nch[NNCACHE];
+struct	nch	*nchash[NCHSZ];
+struct	nch	nchlru;		/* head of LRU list */
+struct	nchstats nchstats;
+struct	nch	*ncfind();
+struct	nch	*nclook();
 
 /*
  * Convert a pathname into a pointer to
@@ -25,6 +33,7 @@ int (*func)();
 	register c;
 	register char *cp;
 	struct buf *bp;
+	struct nch *ncp;
 	int i;
 	dev_t d;
 	off_t eo;
@@ -92,6 +101,26 @@ seloop:
 	if(u.u_error)
 		goto out;
 
+	/*
+	 * Try the name cache, unless the last
+	 * component is to be deleted; then the
+	 * offset of the entry is wanted too.
+	 */
+	if(flag!=2 || c!='\0') {
+		if((ncp = nclook(dp)) != NULL) {
+			if(ncp->nc_ino == 0) {
+				if(flag==1 && c=='\0')
+					goto search;
+				u.u_error = ENOENT;
+				goto out;
+			}
+			u.u_dent.d_ino = ncp->nc_ino;
+			bcopy((caddr_t)u.u_dbuf, (caddr_t)u.u_dent.d_name, DIRSIZ);
+			goto found;
+		}
+	}
+
+search:
 	/*
 	 * set up to search a directory
 	 */
@@ -118,9 +147,10 @@ eloop:
 			if(eo)
 				u.u_offset = eo-sizeof(struct direct);
 			else
-				dp->i_flag |= IUPD|ICHG;
+				imark(dp, IUPD|ICHG);
 			return(NULL);
 		}
+		ncenter(dp, (ino_t)0);
 		u.u_error = ENOENT;
 		goto out;
 	}
@@ -170,6 +200,8 @@ eloop:
 
 	if(bp != NULL)
 		brelse(bp);
+	ncenter(dp, u.u_dent.d_ino);
+found:
 	if(flag==2 && c=='\0') {
 		if(access(dp, IWRITE))
 			goto out;
@@ -222,3 +254,179 @@ uchar()
 		u.u_error = EFAULT;
 	return(c);
 }
+
+/*
+ * Initialize the name cache:
+ * all entries empty, on the LRU list.
+ */
+nchinit()
+{
+	register struct nch *ncp;
+
+	nchlru.nc_lforw = nchlru.nc_lback = &nchlru;
+	for(ncp = &nch[0]; ncp < &nch[NNCACHE]; ncp++) {
+		ncp->nc_dev = NODEV;
+		ncp->nc_lforw = nchlru.nc_lforw;
+		ncp->nc_lback = &nchlru;
+		nchlru.nc_lforw->nc_lback = ncp;
+		nchlru.nc_lforw = ncp;
+	}
+}
+
+/*
+ * Find the entry for the component
+ * in u.u_dbuf in directory dp.
+ */
+struct nch *
+ncfind(dp)
+register struct inode *dp;
+{
+	register struct nch *ncp;
+	register char *cp;
+	int i;
+
+	for(ncp = nchash[NCHHASH(dp->i_dev, dp->i_number, u.u_dbuf)];
+	    ncp != NULL; ncp = ncp->nc_hlink) {
+		if(ncp->nc_dino != dp->i_number || ncp->nc_dev != dp->i_dev)
+			continue;
+		cp = ncp->nc_name;
+		for(i=0; i<DIRSIZ; i++)
+			if(u.u_dbuf[i] != *cp++)
+				goto cont;
+		return(ncp);
+	cont:
+		;
+	}
+	return(NULL);
+}
+
+/*
+ * Look up the component in u.u_dbuf
+ * in directory dp for namei.
+ * A found entry becomes the most recently used.
+ */
+struct nch *
+nclook(dp)
+struct inode *dp;
+{
+	register struct nch *ncp;
+
+	if((ncp = ncfind(dp)) == NULL) {
+		nchstats.ncs_miss++;
+		return(NULL);
+	}
+	if(ncp->nc_ino)
+		nchstats.ncs_hits++;
+	else
+		nchstats.ncs_neghits++;
+	ncp->nc_lback->nc_lforw = ncp->nc_lforw;
+	ncp->nc_lforw->nc_lback = ncp->nc_lback;
+	ncp->nc_lforw = &nchlru;
+	ncp->nc_lback = nchlru.nc_lback;
+	nchlru.nc_lback->nc_lforw = ncp;
+	nchlru.nc_lback = ncp;
+	return(ncp);
+}
+
+/*
+ * Remember that the component in u.u_dbuf
+ * is inumber ino in directory dp (0 if absent).
+ * The least recently used entry is taken
+ * if there is none for the name already.
+ */
+ncenter(dp, ino)
+register struct inode *dp;
+ino_t ino;
+{
+	register struct nch *ncp, **hp;
+
+	if((ncp = ncfind(dp)) == NULL) {
+		ncp = nchlru.nc_lforw;
+		if(ncp == &nchlru)
+			return;
+		ncunhash(ncp);
+		ncp->nc_dev = dp->i_dev;
+		ncp->nc_dino = dp->i_number;
+		bcopy((caddr_t)u.u_dbuf, (caddr_t)ncp->nc_name, DIRSIZ);
+		hp = &nchash[NCHHASH(dp->i_dev, dp->i_number, u.u_dbuf)];
+		if((ncp->nc_hlink = *hp) != NULL)
+			(*hp)->nc_hback = &ncp->nc_hlink;
+		ncp->nc_hback = hp;
+		*hp = ncp;
+	}
+	ncp->nc_ino = ino;
+	ncp->nc_lback->nc_lforw = ncp->nc_lforw;
+	ncp->nc_lforw->nc_lback = ncp->nc_lback;
+	ncp->nc_lforw = &nchlru;
+	ncp->nc_lback = nchlru.nc_lback;
+	nchlru.nc_lback->nc_lforw = ncp;
+	nchlru.nc_lback = ncp;
+	nchstats.ncs_enter++;
+}
+
+/*
+ * Forget the component in u.u_dbuf
+ * in directory dp.
+ * Called whenever the directory entry
+ * is written (wdir, unlink).
+ */
+ncpurge(dp)
+struct inode *dp;
+{
+	register struct nch *ncp;
+
+	if((ncp = ncfind(dp)) != NULL)
+		ncfree(ncp);
+}
+
+/*
+ * Forget every entry naming or in
+ * inode ino of dev, or every entry of dev
+ * if ino is 0.
+ * Called when an inode is freed and
+ * when dev is unmounted.
+ */
+ncinval(dev, ino)
+dev_t dev;
+ino_t ino;
+{
+	register struct nch *ncp;
+
+	for(ncp = &nch[0]; ncp < &nch[NNCACHE]; ncp++) {
+		if(ncp->nc_dev != dev)
+			continue;
+		if(ino==0 || ncp->nc_dino==ino || ncp->nc_ino==ino)
+			ncfree(ncp);
+	}
+}
+
+/*
+ * Empty an entry and put it at the head of
+ * the LRU list, to be reused first.
+ */
+ncfree(ncp)
+register struct nch *ncp;
+{
+
+	ncunhash(ncp);
+	ncp->nc_dev = NODEV;
+	ncp->nc_lback->nc_lforw = ncp->nc_lforw;
+	ncp->nc_lforw->nc_lback = ncp->nc_lback;
+	ncp->nc_lforw = nchlru.nc_lforw;
+	ncp->nc_lback = &nchlru;
+	nchlru.nc_lforw->nc_lback = ncp;
+	nchlru.nc_lforw = ncp;
+	nchstats.ncs_purge++;
+}
+
+ncunhash(ncp)
+register struct nch *ncp;
+{
+
+	if(ncp->nc_hback == NULL)
+		return;
+	if((*ncp->nc_hback = ncp->nc_hlink) != NULL)
+		ncp->nc_hlink->nc_hback = ncp->nc_hback;
+	ncp->nc_hlink = NULL;
+	ncp->nc_hback = NULL;
+}
@@ -5,16 +5,31 @@
 #include "../h/inode.h"
 #include "../h/file.h"
 #include "../h/reg.h"
+#include "../h/buf.h"
 
 /*
- * Max allowable buffering per pipe.
- * This is also the max size of the
- * file created to implement the pipe.
- * If this size is bigger than 5120,
- * pipes will be implemented with large
- * files, which is probably not good.
+ * Pipes are kept in core.  The data is held
+ * in a ring of PIPSIZ bytes in the inode
+ * (i_pbuf, i_prd, i_pcnt), made of buffers
+ * taken from the cache with geteblk as they
+ * are written into and given back as they are
+ * read out, so an idle pipe holds none.
+ * The inode is only used for its name and
+ * reference count; the file system never
+ * sees the data.
+ * A pipe may always have one buffer; the
+ * ones beyond that are counted in npipbuf,
+ * and pipes together may hold no more than
+ * PIPBMAX of them, so that the cache cannot
+ * be eaten up.  A writer that needs more
+ * waits for some to be given back.  As a
+ * writer never waits for its first buffer,
+ * a pipeline can always move some data.
+ * PIPBMAX must be at least PIPSIZ/BSIZE-1.
  */
-#define	PIPSIZ	4096
+#define	PIPBMAX	(NBUF/2)
+int	npipbuf;
+char	pipbwant;
 
 /*
  * The sys-pipe entry.
@@ -26,7 +41,7 @@ pipe()
 {
 	register struct inode *ip;
 	register struct file *rf, *wf;
-	int r;
+	int r, i;
 
 	ip = ialloc(pipedev);
 	if(ip == NULL)
@@ -39,8 +54,8 @@ pipe()
 	r = u.u_r.r_val1;
 	wf = falloc();
 	if(wf == NULL) {
-		rf->f_count = 0;
-		u.u_ofile[r] = NULL;
+		ffree(rf);
+		ufree(r);
 		iput(ip);
 		return;
 	}
@@ -52,29 +67,36 @@ pipe()
 	rf->f_inode = ip;
 	ip->i_count = 2;
 	ip->i_mode = IFREG;
-	ip->i_flag = IACC|IUPD|ICHG;
+	ip->i_flag = IPIPE;
+	imark(ip, IACC|IUPD|ICHG);
+	for(i=0; i<PIPSIZ/BSIZE; i++)
+		ip->i_pbuf[i] = NULL;
+	ip->i_prd = 0;
+	ip->i_pcnt = 0;
 }
 
 /*
  * Read call directed to a pipe.
+ * Take what there is, up to the
+ * count asked for, and wake the
+ * writer once there is room.
  */
 readp(fp)
 register struct file *fp;
 {
 	register struct inode *ip;
+	register n;
+	struct buf *bp;
+	int i;
 
 	ip = fp->f_inode;
 
 loop:
-	/*
-	 * Very conservative locking.
-	 */
-
 	plock(ip);
 	/*
 	 * If nothing in the pipe, wait.
 	 */
-	if (ip->i_size == 0) {
+	if (ip->i_pcnt == 0) {
 		/*
 		 * If there are not both reader and
 		 * writer active, return without
@@ -88,39 +110,52 @@ loop:
 		goto loop;
 	}
 
-	/*
-	 * Read and return
-	 */
-
-	u.u_offset = fp->f_un.f_offset;
-	readi(ip);
-	fp->f_un.f_offset = u.u_offset;
-	/*
-	 * If reader has caught up with writer, reset
-	 * offset and size to 0.
-	 */
-	if (fp->f_un.f_offset == ip->i_size) {
-		fp->f_un.f_offset = 0;
-		ip->i_size = 0;
-		if(ip->i_mode & IWRITE) {
-			ip->i_mode &= ~IWRITE;
-			wakeup((caddr_t)ip+1);
+	while(u.u_count && ip->i_pcnt) {
+		i = ip->i_prd>>BSHIFT;
+		bp = ip->i_pbuf[i];
+		n = min(BSIZE - (ip->i_prd&BMASK), ip->i_pcnt);
+		n = min(n, u.u_count);
+		iomove(bp->b_un.b_addr + (ip->i_prd&BMASK), n, B_READ);
+		if(u.u_error)
+			break;
+		ip->i_pcnt -= n;
+		ip->i_prd += n;
+		if(ip->i_prd >= PIPSIZ)
+			ip->i_prd = 0;
+		/*
+		 * Give back a buffer once it has been
+		 * read out, unless the writer has come
+		 * round into it again.
+		 */
+		if(ip->i_pcnt == 0)
+			pfree(ip);
+		else if((ip->i_prd&BMASK) == 0 &&
+		   ((ip->i_prd+ip->i_pcnt)%PIPSIZ)>>BSHIFT != i) {
+			pbrelse(ip, i);
 		}
 	}
+	ip->i_size = ip->i_pcnt;
+	if((ip->i_mode&IWRITE) && ip->i_pcnt <= PIPSIZ/2) {
+		ip->i_mode &= ~IWRITE;
+		wakeup((caddr_t)ip+1);
+	}
 	prele(ip);
 }
 
 /*
  * Write call directed to a pipe.
+ * A write of no more than PIPSIZ
+ * waits for room for all of it, so
+ * that it is not mixed with others.
  */
 writep(fp)
 register struct file *fp;
 {
-	register c;
+	register n, c;
 	register struct inode *ip;
+	int w;
 
 	ip = fp->f_inode;
-	c = u.u_count;
 
 loop:
 
@@ -129,9 +164,8 @@ loop:
 	 */
 
 	plock(ip);
-	if(c == 0) {
+	if(u.u_count == 0) {
 		prele(ip);
-		u.u_count = 0;
 		return;
 	}
 
@@ -149,36 +183,156 @@ loop:
 	}
 
 	/*
-	 * If the pipe is full,
-	 * wait for reads to deplete
-	 * and truncate it.
+	 * If the pipe is too full,
+	 * wait for reads to deplete it.
+	 */
+
+	n = PIPSIZ - ip->i_pcnt;
+	if(n == 0 || (u.u_count <= PIPSIZ && n < u.u_count))
+		goto wait;
+	if(n > u.u_count)
+		n = u.u_count;
+
+	/*
+	 * Get the buffers before copying
+	 * anything: all of them for a write
+	 * that must not be mixed with others.
 	 */
 
-	if(ip->i_size >= PIPSIZ) {
-		ip->i_mode |= IWRITE;
+	n = pgetbuf(ip, n, u.u_count <= PIPSIZ);
+	if(n == 0) {
+		pipbwant++;
 		prele(ip);
-		sleep((caddr_t)ip+1, PPIPE);
+		sleep((caddr_t)&npipbuf, PPIPE);
 		goto loop;
 	}
 
 	/*
-	 * Write what is possible and
-	 * loop back.
-	 * If writing less than PIPSIZ, it always goes.
-	 * One can therefore get a file > PIPSIZ if write
-	 * sizes do not divide PIPSIZ.
+	 * Copy in what there is room for,
+	 * then wake the reader once.
 	 */
 
-	u.u_offset = ip->i_size;
-	u.u_count = min((unsigned)c, (unsigned)PIPSIZ);
-	c -= u.u_count;
-	writei(ip);
-	prele(ip);
+	while(n) {
+		w = (ip->i_prd + ip->i_pcnt) % PIPSIZ;
+		c = min(BSIZE - (w&BMASK), n);
+		iomove(ip->i_pbuf[w>>BSHIFT]->b_un.b_addr + (w&BMASK),
+		    c, B_WRITE);
+		if(u.u_error)
+			break;
+		ip->i_pcnt += c;
+		n -= c;
+	}
+	ip->i_size = ip->i_pcnt;
 	if(ip->i_mode&IREAD) {
 		ip->i_mode &= ~IREAD;
 		wakeup((caddr_t)ip+2);
 	}
+	prele(ip);
+	if(u.u_error)
+		return;
 	goto loop;
+
+	/*
+	 * Out of room.
+	 */
+
+wait:
+	ip->i_mode |= IWRITE;
+	prele(ip);
+	sleep((caddr_t)ip+1, PPIPE);
+	goto loop;
+}
+
+/*
+ * See that the ring of ip has buffers
+ * for the next n bytes written into it,
+ * which there is room for.  Returns how
+ * many of the n there are buffers for:
+ * the pipe's first buffer, if it has none,
+ * and as many more as pipes' share of the
+ * cache allows.  If that is not all of
+ * them and all is set, none are taken and
+ * 0 is returned.
+ */
+pgetbuf(ip, n, all)
+register struct inode *ip;
+{
+	register w, c;
+	int m, e, f;
+
+	f = 1;
+	for(e = 0; e < PIPSIZ/BSIZE; e++)
+		if(ip->i_pbuf[e] != NULL)
+			f = 0;
+	w = (ip->i_prd + ip->i_pcnt) % PIPSIZ;
+	m = 0;
+	for(c = 0; c < n; c += e) {
+		if(ip->i_pbuf[(w+c)%PIPSIZ>>BSHIFT] == NULL) {
+			if(f)
+				f = 0;
+			else if(npipbuf+m >= PIPBMAX)
+				break;
+			else
+				m++;
+		}
+		e = BSIZE - ((w+c)&BMASK);
+	}
+	if(c > n)
+		c = n;
+	if(c < n && all)
+		return(0);
+	/*
+	 * Count them first: geteblk may sleep,
+	 * and other pipes must not take them.
+	 */
+	npipbuf += m;
+	for(e = 0; e < c; e += BSIZE - ((w+e)&BMASK))
+		if(ip->i_pbuf[(w+e)%PIPSIZ>>BSHIFT] == NULL)
+			ip->i_pbuf[(w+e)%PIPSIZ>>BSHIFT] = geteblk();
+	return(c);
+}
+
+/*
+ * Give back buffer i of the ring of ip,
+ * and wake any writer waiting for one.
+ * Unless it was the pipe's last, it was
+ * counted in npipbuf.
+ */
+pbrelse(ip, i)
+register struct inode *ip;
+{
+	register j;
+
+	brelse(ip->i_pbuf[i]);
+	ip->i_pbuf[i] = NULL;
+	for(j = 0; j < PIPSIZ/BSIZE; j++)
+		if(ip->i_pbuf[j] != NULL) {
+			npipbuf--;
+			break;
+		}
+	if(pipbwant) {
+		pipbwant = 0;
+		wakeup((caddr_t)&npipbuf);
+	}
+}
+
+/*
+ * Give back all of a pipe's
+ * buffers and empty it.
+ * Called when the reader catches
+ * up and on the last close.
+ */
+pfree(ip)
+register struct inode *ip;
+{
+	register i;
+
+	for(i = 0; i < PIPSIZ/BSIZE; i++)
+		if(ip->i_pbuf[i] != NULL)
+			pbrelse(ip, i);
+	ip->i_prd = 0;
+	ip->i_pcnt = 0;
+	ip->i_size = 0;
 }
 
 /*
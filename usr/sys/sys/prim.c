@@ -66,6 +66,7 @@ register char *cp;
 	if (q->c_cc <= 0) {
 		q->c_cc = 0;
 		q->c_cf = q->c_cl = NULL;
+		splx(s);
 		return(0);
 	}
 	acp = cp;
@@ -5,6 +5,11 @@
 #include "../h/user.h"
 #include "../h/buf.h"
 #include "../h/conf.h"
+#include "../h/proc.h"
+#include "../h/seg.h"
+#include "../h/text.h"
+
+#define	XCLUST	32		/* most blocks moved at once by readx */
 
 /*
  * Read the file corresponding to
@@ -22,6 +27,7 @@ register struct inode *ip;
 	struct buf *bp;
 	dev_t dev;
 	daddr_t lbn, bn;
+	daddr_t rablks[RAMAX];
 	off_t diff;
 	register on, n;
 	register type;
@@ -32,7 +38,7 @@ register struct inode *ip;
 		u.u_error = EINVAL;
 		return;
 	}
-	ip->i_flag |= IACC;
+	imark(ip, IACC);
 	dev = (dev_t)ip->i_un.i_rdev;
 	type = ip->i_mode&IFMT;
 	if (type==IFCHR || type==IFMPC) {
@@ -59,9 +65,12 @@ register struct inode *ip;
 			bp = geteblk();
 			clrbuf(bp);
 		} else if (ip->i_un.i_lastr+1==lbn)
-			bp = breada(dev, bn, rablock);
-		else
+			bp = breadn(dev, bn, rablks, rdahead(ip, lbn, rablks));
+		else {
+			ip->i_un.i_rawin >>= 1;
+			ip->i_un.i_rablk = lbn;
 			bp = bread(dev, bn);
+		}
 		ip->i_un.i_lastr = lbn;
 		n = min((unsigned)n, BSIZE-bp->b_resid);
 		if (n!=0)
@@ -70,6 +79,139 @@ register struct inode *ip;
 	} while(u.u_error==0 && u.u_count!=0 && n>0);
 }
 
+/*
+ * Choose the blocks to read ahead of logical
+ * block lbn of a file that is being read
+ * sequentially, leave their device addresses
+ * in rablks and return how many there are.
+ * The window doubles on each sequential read,
+ * up to RAMAX blocks, and is halved by readi
+ * on each random one.  Blocks read ahead
+ * earlier are not asked for again.
+ * Called right after bmap of lbn, which
+ * has left the next block in rablock.
+ */
+rdahead(ip, lbn, rablks)
+register struct inode *ip;
+daddr_t lbn;
+daddr_t *rablks;
+{
+	register n, type;
+	daddr_t rbn, last, bn;
+
+	n = ip->i_un.i_rawin;
+	n = n? n<<1: 1;
+	if (n > RAMAX)
+		n = RAMAX;
+	ip->i_un.i_rawin = n;
+	type = ip->i_mode&IFMT;
+	last = lbn + n;
+	if (type!=IFBLK && type!=IFMPB && last > (ip->i_size-1) >> BSHIFT)
+		last = (ip->i_size-1) >> BSHIFT;
+	rbn = ip->i_un.i_rablk;
+	if (rbn < lbn)
+		rbn = lbn;
+	n = 0;
+	while (++rbn <= last) {
+		if (type==IFBLK || type==IFMPB)
+			bn = rbn;
+		else if (rbn == lbn+1 && rablock)
+			bn = rablock;
+		else {
+			bn = bmap(ip, rbn, B_READ);
+			if (u.u_error) {
+				u.u_error = 0;
+				bn = 0;
+			}
+		}
+		if (bn <= 0)
+			break;
+		rablks[n++] = bn;
+	}
+	ip->i_un.i_rablk = rbn-1;
+	return(n);
+}
+
+/*
+ * Read a program from ip into user core,
+ * as readi would, for exec.  Runs of whole
+ * blocks that are contiguous on the disk and
+ * not in the buffer cache are moved straight
+ * into core, up to XCLUST blocks at a time;
+ * cached blocks, holes and the pieces at each
+ * end go through the cache.  u_segflg is 0
+ * for the data space, 2 for the text.
+ */
+readx(ip)
+register struct inode *ip;
+{
+	register struct buf *bp;
+	register n;
+	daddr_t lbn, bn, nb;
+	off_t diff;
+	unsigned on, va;
+	int a, lock;
+
+	if(u.u_count == 0)
+		return;
+	imark(ip, IACC);
+	lock = u.u_procp->p_flag&SLOCK;
+	do {
+		diff = ip->i_size - u.u_offset;
+		if(diff <= 0)
+			return;
+		lbn = u.u_offset >> BSHIFT;
+		on = u.u_offset & BMASK;
+		bn = bmap(ip, lbn, B_READ);
+		if(u.u_error)
+			return;
+		va = (unsigned)u.u_base;
+		n = 0;
+		if(on == 0 && (va&01) == 0 && (long)bn > 0)
+			while(n < XCLUST && (n+1)*BSIZE <= u.u_count &&
+			    (n+1)*BSIZE <= diff) {
+				nb = n? bmap(ip, lbn+n, B_READ): bn;
+				if(u.u_error || nb != bn+n ||
+				   incore(ip->i_dev, nb))
+					break;
+				n++;
+			}
+		u.u_error = 0;
+		if(n) {
+			/*
+			 * Find the core by simulating
+			 * the segmentation hardware.
+			 */
+			a = ((u.u_segflg || !u.u_sep)? UISA: UDSA)->r[va>>13];
+			a += (va>>6) & 0177;
+			u.u_procp->p_flag |= SLOCK;
+			physrd(ip->i_dev, bn, a, va&077, n*BSIZE);
+			if(lock == 0)
+				u.u_procp->p_flag &= ~SLOCK;
+			xstats.xs_rawx++;
+			xstats.xs_rawb += n;
+			u.u_ior += n;
+			n *= BSIZE;
+			u.u_base += n;
+			u.u_offset += n;
+			u.u_count -= n;
+		} else {
+			n = min((unsigned)(BSIZE-on), u.u_count);
+			if(diff < n)
+				n = diff;
+			if((long)bn < 0) {
+				bp = geteblk();
+				clrbuf(bp);
+			} else
+				bp = bread(ip->i_dev, bn);
+			n = min((unsigned)n, BSIZE-bp->b_resid);
+			if(n != 0)
+				iomove(bp->b_un.b_addr+on, n, B_READ);
+			brelse(bp);
+		}
+	} while(u.u_error==0 && u.u_count!=0 && n>0);
+}
+
 /*
  * Write the file corresponding to
  * the inode pointed at by the argument.
@@ -96,7 +238,7 @@ register struct inode *ip;
 	dev = (dev_t)ip->i_un.i_rdev;
 	type = ip->i_mode&IFMT;
 	if (type==IFCHR || type==IFMPC) {
-		ip->i_flag |= IUPD|ICHG;
+		imark(ip, IUPD|ICHG);
 		(*cdevsw[major(dev)].d_write)(dev);
 		return;
 	}
@@ -120,12 +262,15 @@ register struct inode *ip;
 		iomove(bp->b_un.b_addr+on, n, B_WRITE);
 		if(u.u_error != 0)
 			brelse(bp);
-		else
+		else {
 			bdwrite(bp);
+			if(on+n == BSIZE && type == IFREG)
+				bwbehind(dev, bn);
+		}
 		if(u.u_offset > ip->i_size &&
 		   (type==IFDIR || type==IFREG))
 			ip->i_size = u.u_offset;
-		ip->i_flag |= IUPD|ICHG;
+		imark(ip, IUPD|ICHG);
 	} while(u.u_error==0 && u.u_count!=0);
 }
 
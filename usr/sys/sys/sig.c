@@ -62,7 +62,7 @@ register sig;
 	if(sig)
 		p->p_sig |= 1<<(sig-1);
 	if(p->p_pri > PUSER)
-		p->p_pri = PUSER;
+		newpri(p, PUSER);
 	if(p->p_stat == SSLEEP && p->p_pri > PZERO)
 		setrun(p);
 }
@@ -199,6 +199,8 @@ core()
 	register unsigned s;
 	extern schar();
 
+	if(u.u_dlpage)
+		dlfill(u.u_dlpage);
 	u.u_error = 0;
 	u.u_dirp = "core";
 	ip = namei(schar, 1);
@@ -243,9 +245,13 @@ unsigned sp;
 
 	if(sp >= -ctob(u.u_ssize))
 		return(0);
+	if(u.u_vfork)
+		return(0);
 	si = (-sp)/64 - u.u_ssize + SINCR;
 	if(si <= 0)
 		return(0);
+	if(u.u_dlpage)
+		dlfill(u.u_dlpage);
 	if(estabur(u.u_tsize, u.u_dsize, u.u_ssize+si, u.u_sep, RO))
 		return(0);
 	p = u.u_procp;
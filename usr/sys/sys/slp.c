@@ -13,6 +13,20 @@
 #define HASH(x)	(( (int) x >> 5) & (SQSIZE-1))
 struct proc *slpque[SQSIZE];
 
+/*
+ * Run queues, one for each band of 8 priorities,
+ * each kept in FIFO order, and a bitmap of the bands
+ * that are not empty, so that neither queueing a
+ * process nor finding the best one to run needs a
+ * walk over all the runnable processes.
+ * A queued process has p_rq one more than its band.
+ */
+#define	NRQ	32
+#define	RQB(pri)	(((pri)+128) >> 3)
+struct proc *rqhead[NRQ];
+struct proc *rqtail[NRQ];
+unsigned rqbits[NRQ/16];
+
 /*
  * Give up the processor till a wakeup occurs
  * on chan, at which time the process
@@ -110,29 +124,98 @@ register caddr_t chan;
 }
 
 /*
- * when you are sure that it
- * is impossible to get the
- * 'proc on q' diagnostic, the
- * diagnostic loop can be removed.
+ * Put p at the end of the
+ * run queue for its priority.
  */
 setrq(p)
-struct proc *p;
+register struct proc *p;
+{
+	register b, s;
+
+	s = spl6();
+	if(p->p_rq) {
+		printf("proc on q\n");
+		goto out;
+	}
+	b = RQB(p->p_pri);
+	p->p_rq = b+1;
+	p->p_link = NULL;
+	if(rqhead[b] == NULL)
+		rqhead[b] = p; else
+		rqtail[b]->p_link = p;
+	rqtail[b] = p;
+	rqbits[b>>4] |= 1<<(b&017);
+out:
+	splx(s);
+}
+
+/*
+ * Take p off its run queue, if it is on one.
+ */
+remrq(p)
+register struct proc *p;
 {
 	register struct proc *q;
-	register s;
+	register b;
+	int s;
 
 	s = spl6();
-	for(q=runq; q!=NULL; q=q->p_link)
-		if(q == p) {
-			printf("proc on q\n");
-			goto out;
-		}
-	p->p_link = runq;
-	runq = p;
+	if((b = p->p_rq-1) < 0)
+		goto out;
+	q = rqhead[b];
+	if(q == p)
+		q = NULL;
+	else {
+		while(q != NULL && q->p_link != p)
+			q = q->p_link;
+		if(q == NULL)
+			panic("remrq");
+	}
+	rqunlink(b, p, q);
 out:
 	splx(s);
 }
 
+/*
+ * Unlink p, which follows q (NULL if p
+ * is first), from the queue for band b.
+ * (internal interface, called at spl6)
+ */
+rqunlink(b, p, q)
+register b;
+register struct proc *p, *q;
+{
+
+	if(q == NULL)
+		rqhead[b] = p->p_link; else
+		q->p_link = p->p_link;
+	if(rqtail[b] == p)
+		rqtail[b] = q;
+	if(rqhead[b] == NULL)
+		rqbits[b>>4] &= ~(1<<(b&017));
+	p->p_rq = 0;
+}
+
+/*
+ * Give p priority pri, moving it to
+ * the matching run queue if it is queued.
+ */
+newpri(p, pri)
+register struct proc *p;
+register pri;
+{
+	int s;
+
+	s = spl6();
+	if(p->p_rq && RQB(pri) != p->p_rq-1) {
+		remrq(p);
+		p->p_pri = pri;
+		setrq(p);
+	} else
+		p->p_pri = pri;
+	splx(s);
+}
+
 /*
  * Set the process running;
  * arrange for it to be swapped in if necessary.
@@ -179,7 +262,7 @@ register struct proc *pp;
 		p = 127;
 	if(p < curpri)
 		runrun++;
-	pp->p_pri = p;
+	newpri(pp, p);
 	return(p);
 }
 
@@ -189,8 +272,12 @@ register struct proc *pp;
  * The basic idea is:
  *  see if anyone wants to be swapped in;
  *  swap out processes until there is room;
- *  swap him in;
+ *  swap them in;
  *  repeat.
+ * Processes going the same way are moved together:
+ * all their transfers are queued to the swap device
+ * before any is waited for, so the driver can sort
+ * them into one sweep.
  * The runout flag is set whenever someone is swapped out.
  * Sched sleeps on it awaiting work.
  *
@@ -202,94 +289,189 @@ register struct proc *pp;
 sched()
 {
 	register struct proc *rp, *p;
-	register outage, inage;
-	int maxsize;
-
-	/*
-	 * find user to swap in;
-	 * of users ready, select one out longest
-	 */
+	register struct text *xp;
+	int n, i, need, outage;
+	struct proc *sp[NSWBUF];
+	int sa[NSWBUF];
+	struct proc *swvictim();
 
 loop:
-	spl6();
-	outage = -20000;
-	for (rp = &proc[0]; rp < &proc[NPROC]; rp++)
-	if (rp->p_stat==SRUN && (rp->p_flag&SLOAD)==0 &&
-	    rp->p_time - (rp->p_nice-NZERO)*8 > outage) {
-		p = rp;
-		outage = rp->p_time - (rp->p_nice-NZERO)*8;
-	}
 	/*
-	 * If there is no one there, wait.
+	 * find users to swap in;
+	 * of users ready, take the ones the
+	 * swapper wants most, as many as fit.
+	 * Those being read in are marked SLOCK.
 	 */
-	if (outage == -20000) {
-		runout++;
-		sleep((caddr_t)&runout, PSWP);
-		goto loop;
+	n = 0;
+	for (;;) {
+		spl6();
+		p = NULL;
+		outage = -20000;
+		for (rp = &proc[0]; rp < &proc[NPROC]; rp++)
+		if (rp->p_stat==SRUN && (rp->p_flag&(SLOAD|SLOCK))==0 &&
+		    (i = inwant(rp)) > outage) {
+			p = rp;
+			outage = i;
+		}
+		/*
+		 * If there is no one there, wait.
+		 */
+		if (p == NULL) {
+			if (n)
+				break;
+			runout++;
+			sleep((caddr_t)&runout, PSWP);
+			goto loop;
+		}
+		spl0();
+		if (n >= NSWBUF)
+			break;
+		/*
+		 * See if there is core for that process;
+		 * if so, start reading it in.
+		 */
+		if ((sa[n] = swinstart(p)) == 0)
+			break;
+		sp[n++] = p;
 	}
 	spl0();
+	if (n) {
+		swwait();
+		while (--n >= 0)
+			swindone(sp[n], sa[n]);
+		goto loop;
+	}
 
 	/*
-	 * See if there is core for that process;
-	 * if so, swap it in.
+	 * none found.
+	 * look around for core, enough for p
+	 * and its text if that is not in core.
 	 */
-
-	if (swapin(p))
+	need = p->p_size;
+	if ((xp = p->p_textp) && xp->x_ccount == 0)
+		need += xp->x_size;
+	/*
+	 * Cached texts nobody is using go first.
+	 */
+	if ((need -= xcreclaim(need)) <= 0)
 		goto loop;
-
+	for (n = 0; n < NSWBUF && need > 0; n++) {
+		spl6();
+		rp = swvictim(p->p_time >= 3);
+		if (rp == NULL) {
+			spl0();
+			break;
+		}
+		rp->p_flag &= ~SLOAD;
+		spl0();
+		need -= coresize(rp);
+		sp[n] = rp;
+		sa[n] = xswout(rp, 0);
+	}
+	if (n) {
+		swwait();
+		while (--n >= 0)
+			xswdone(sp[n], 1, 0, sa[n]);
+		goto loop;
+	}
 	/*
-	 * none found.
-	 * look around for core.
-	 * Select the largest of those sleeping
-	 * at bad priority; if none, select the oldest.
+	 * Otherwise wait a bit and try again.
 	 */
-
 	spl6();
+	runin++;
+	sleep((caddr_t)&runin, PSWP);
+	goto loop;
+}
+
+/*
+ * How much the swapper wants to bring p in:
+ * the longer out the better, less so when it
+ * is niced or was a heavy CPU user.  One whose
+ * text is already in core costs only its data,
+ * and goes ahead of others about as old.
+ */
+inwant(p)
+register struct proc *p;
+{
+	register struct text *xp;
+	register n;
+
+	n = p->p_time - (p->p_nice-NZERO)*8 - (p->p_cpu&0377)/16;
+	if ((xp = p->p_textp) && xp->x_ccount)
+		n += 2;
+	return(n);
+}
+
+/*
+ * Core that swapping p out would free:
+ * its image, and its text if no other
+ * process in core is using it.
+ */
+coresize(p)
+register struct proc *p;
+{
+	register struct text *xp;
+	register n;
+
+	n = p->p_size;
+	if ((xp = p->p_textp) && xp->x_ccount == 1)
+		n += xp->x_size;
+	return(n);
+}
+
+/*
+ * Choose a process to swap out, or NULL.
+ * Sleepers at bad priority and stopped processes
+ * go first, those freeing the most core first.
+ * Failing those, and only if late is set (the process
+ * waiting has been out at least 3 seconds), take one
+ * that has been in core at least 2 seconds, the
+ * heaviest recent CPU user and the longest in first.
+ * Called at spl6.
+ */
+struct proc *
+swvictim(late)
+{
+	register struct proc *rp, *p;
+	register n;
+	int maxsize, inage;
+
 	p = NULL;
 	maxsize = -1;
 	inage = -1;
 	for (rp = &proc[0]; rp < &proc[NPROC]; rp++) {
 		if (rp->p_stat==SZOMB
-		 || (rp->p_flag&(SSYS|SLOCK|SULOCK|SLOAD))!=SLOAD)
+		 || (rp->p_flag&(SSYS|SLOCK|SULOCK|SAIO|SLOAD))!=SLOAD)
 			continue;
 		if (rp->p_textp && rp->p_textp->x_flag&XLOCK)
 			continue;
 		if (rp->p_stat==SSLEEP&&rp->p_pri>=PZERO || rp->p_stat==SSTOP) {
-			if (maxsize < rp->p_size) {
+			if (maxsize < (n = coresize(rp))) {
 				p = rp;
-				maxsize = rp->p_size;
+				maxsize = n;
 			}
-		} else if (maxsize<0 && (rp->p_stat==SRUN||rp->p_stat==SSLEEP)) {
-			if (rp->p_time+rp->p_nice-NZERO > inage) {
+		} else if (maxsize<0 && late && rp->p_time>=2 &&
+		    (rp->p_stat==SRUN||rp->p_stat==SSLEEP)) {
+			n = rp->p_time + rp->p_nice - NZERO + (rp->p_cpu&0377)/16;
+			if (n > inage) {
 				p = rp;
-				inage = rp->p_time+rp->p_nice-NZERO;
+				inage = n;
 			}
 		}
 	}
-	spl0();
-	/*
-	 * Swap found user out if sleeping at bad pri,
-	 * or if he has spent at least 2 seconds in core and
-	 * the swapped-out process has spent at least 3 seconds out.
-	 * Otherwise wait a bit and try again.
-	 */
-	if (maxsize>=0 || (outage>=3 && inage>=2)) {
-		p->p_flag &= ~SLOAD;
-		xswap(p, 1, 0);
-		goto loop;
-	}
-	spl6();
-	runin++;
-	sleep((caddr_t)&runin, PSWP);
-	goto loop;
+	return(p);
 }
 
 /*
- * Swap a process in.
+ * Start swapping a process in.
  * Allocate data and possible text separately.
- * It would be better to do largest first.
+ * The text, which others may be waiting for, is
+ * read at once; the read of the data is only queued,
+ * and the process is marked SLOCK until swindone.
+ * Returns the core address of the data, or 0 if
+ * there was not room.
  */
-swapin(p)
+swinstart(p)
 register struct proc *p;
 {
 	register struct text *xp;
@@ -313,12 +495,24 @@ register struct proc *p;
 		xp->x_ccount++;
 		xunlock(xp);
 	}
-	swap(p->p_addr, a, p->p_size, B_READ);
+	p->p_flag |= SLOCK;
+	swstart(p->p_addr, a, p->p_size, B_READ);
+	return(a);
+}
+
+/*
+ * Finish swapping p in to core at a,
+ * after swwait.
+ */
+swindone(p, a)
+register struct proc *p;
+{
+
 	mfree(swapmap, ctod(p->p_size), p->p_addr);
 	p->p_addr = a;
 	p->p_flag |= SLOAD;
+	p->p_flag &= ~SLOCK;
 	p->p_time = 0;
-	return(1);
 }
 
 /*
@@ -347,7 +541,9 @@ qswtch()
 swtch()
 {
 	register n;
-	register struct proc *p, *q, *pp, *pq;
+	register struct proc *p, *q;
+	register unsigned m;
+	int w;
 
 	/*
 	 * If not the idle process, resume the idle process.
@@ -379,36 +575,32 @@ swtch()
 loop:
 	spl6();
 	runrun = 0;
-	pp = NULL;
-	q = NULL;
-	n = 128;
 	/*
-	 * Search for highest-priority runnable process
+	 * Take the first process in core from the
+	 * best band that has one.  Usually that is the
+	 * head of the first non-empty queue; runnable
+	 * processes that are swapped out are passed over.
 	 */
-	for(p=runq; p!=NULL; p=p->p_link) {
-		if((p->p_stat==SRUN) && (p->p_flag&SLOAD)) {
-			if(p->p_pri < n) {
-				pp = p;
-				pq = q;
-				n = p->p_pri;
-			}
+	for(w = 0; w < NRQ/16; w++)
+	for(n = w<<4, m = rqbits[w]; m; n++, m >>= 1) {
+		if((m&1) == 0)
+			continue;
+		q = NULL;
+		for(p = rqhead[n]; p != NULL; p = p->p_link) {
+			if(p->p_stat==SRUN && (p->p_flag&SLOAD))
+				goto found;
+			q = p;
 		}
-		q = p;
 	}
 	/*
 	 * If no process is runnable, idle.
 	 */
-	p = pp;
-	if(p == NULL) {
-		idle();
-		goto loop;
-	}
-	q = pq;
-	if(q == NULL)
-		runq = p->p_link;
-	else
-		q->p_link = p->p_link;
-	curpri = n;
+	idle();
+	goto loop;
+
+found:
+	rqunlink(n, p, q);
+	curpri = p->p_pri;
 	spl0();
 	/*
 	 * The rsav (ssav) contents are interpreted in the new address space
@@ -422,8 +614,13 @@ loop:
  * Create a new process-- the internal version of
  * sys fork.
  * It returns 1 in the new process, 0 in the old.
+ * For vfork the new process gets only a copy
+ * of the user block and runs in the old one's
+ * image (see sureg), which is locked in core
+ * and marked SVFORK until the child gives it
+ * back in vfrelse.
  */
-newproc()
+newproc(isvfork)
 {
 	int a1, a2;
 	struct proc *p, *up;
@@ -504,6 +701,16 @@ retry:
 		sureg();
 		return(1);
 	}
+	if(isvfork && (a2 = malloc(coremap, USIZE)) != NULL) {
+		rpp->p_addr = a2;
+		rpp->p_size = USIZE;
+		u.u_vfork = rip;
+		for(n=0; n<USIZE; n++)
+			copyseg(a1+n, a2+n);
+		u.u_vfork = NULL;
+		rip->p_flag |= SVFORK|SLOCK;
+		goto out;
+	}
 	a2 = malloc(coremap, n);
 	/*
 	 * If there is not enough core for the
@@ -523,6 +730,7 @@ retry:
 		while(n--)
 			copyseg(a1++, a2++);
 	}
+out:
 	u.u_procp = rip;
 	setrq(rpp);
 	rpp->p_flag |= SSWAP;
@@ -541,6 +749,8 @@ retry:
  *
  * After the expansion, the caller will take care of copying
  * the user's stack towards or away from the data area.
+ * Asynchronous raw transfers to the image
+ * are finished first, since it may move.
  */
 expand(newsize)
 {
@@ -548,6 +758,7 @@ expand(newsize)
 	register struct proc *p;
 	register a1, a2;
 
+	aiodrain();
 	p = u.u_procp;
 	n = p->p_size;
 	p->p_size = newsize;
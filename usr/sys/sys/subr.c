@@ -6,6 +6,16 @@
 #include "../h/user.h"
 #include "../h/buf.h"
 
+#define	BMAPMON	1
+
+#ifdef	BMAPMON
+struct {
+	long	nind;		/* lookups past the direct blocks */
+	long	nhit;		/* answered from the inode's map cache */
+	long	nsaved;		/* indirect block reads saved by hits */
+} bm_info;
+#endif
+
 /*
  * Bmap defines the structure of file system storage
  * by returning the physical block number on a device given the
@@ -13,6 +23,15 @@
  * When convenient, it also leaves the physical
  * block number of the next block of the file in rablock
  * for use in read-ahead.
+ * New blocks are asked for just after the block
+ * that precedes them in the file, so that on a
+ * bitmap file system files are laid out in order.
+ * Each inode remembers the run of contiguous
+ * blocks last found through its indirect blocks,
+ * so sequential reads of large files need not
+ * go back to the indirect blocks for every block.
+ * The run is forgotten when a block is allocated
+ * and in itrunc.
  */
 daddr_t
 bmap(ip, bn, rwflg)
@@ -21,8 +40,8 @@ daddr_t bn;
 {
 	register i;
 	struct buf *bp, *nbp;
-	int j, sh;
-	daddr_t nb, *bap;
+	int j, sh, lev, new;
+	daddr_t nb, lbn, *bap;
 	dev_t dev;
 
 	if(bn < 0) {
@@ -39,18 +58,39 @@ daddr_t bn;
 		i = bn;
 		nb = ip->i_un.i_addr[i];
 		if(nb == 0) {
-			if(rwflg==B_READ || (bp = alloc(dev))==NULL)
+			nb = i? ip->i_un.i_addr[i-1]+1: 0;
+			if(rwflg==B_READ || (bp = alloc(dev, nb))==NULL)
 				return((daddr_t)-1);
 			nb = bp->b_blkno;
 			bdwrite(bp);
 			ip->i_un.i_addr[i] = nb;
-			ip->i_flag |= IUPD|ICHG;
+			imark(ip, IUPD|ICHG);
 		}
 		if(i < NADDR-4)
 			rablock = ip->i_un.i_addr[i+1];
 		return(nb);
 	}
 
+#ifdef	BMAPMON
+	bm_info.nind++;
+#endif
+	/*
+	 * look in the map cache
+	 */
+	if(ip->i_un.i_clen && bn >= ip->i_un.i_cbn &&
+	   bn < ip->i_un.i_cbn+ip->i_un.i_clen) {
+		i = bn - ip->i_un.i_cbn;
+		nb = ip->i_un.i_cpbn + i;
+		rablock = i+1 < ip->i_un.i_clen? nb+1: ip->i_un.i_cnext;
+#ifdef	BMAPMON
+		bm_info.nhit++;
+		bm_info.nsaved += ip->i_un.i_clev;
+#endif
+		return(nb);
+	}
+	lbn = bn;
+	new = 0;
+
 	/*
 	 * addresses NADDR-3, NADDR-2, and NADDR-1
 	 * have single, double, triple indirect blocks.
@@ -71,18 +111,21 @@ daddr_t bn;
 		u.u_error = EFBIG;
 		return((daddr_t)0);
 	}
+	lev = 4-j;
 
 	/*
 	 * fetch the address from the inode
 	 */
 	nb = ip->i_un.i_addr[NADDR-j];
 	if(nb == 0) {
-		if(rwflg==B_READ || (bp = alloc(dev))==NULL)
+		nb = ip->i_un.i_addr[NADDR-j-1]+1;
+		if(rwflg==B_READ || (bp = alloc(dev, nb))==NULL)
 			return((daddr_t)-1);
 		nb = bp->b_blkno;
 		bdwrite(bp);
 		ip->i_un.i_addr[NADDR-j] = nb;
-		ip->i_flag |= IUPD|ICHG;
+		imark(ip, IUPD|ICHG);
+		new++;
 	}
 
 	/*
@@ -99,7 +142,8 @@ daddr_t bn;
 		i = (bn>>sh) & NMASK;
 		nb = bap[i];
 		if(nb == 0) {
-			if(rwflg==B_READ || (nbp = alloc(dev))==NULL) {
+			nb = i? bap[i-1]+1: bp->b_blkno+1;
+			if(rwflg==B_READ || (nbp = alloc(dev, nb))==NULL) {
 				brelse(bp);
 				return((daddr_t)-1);
 			}
@@ -107,15 +151,29 @@ daddr_t bn;
 			bdwrite(nbp);
 			bap[i] = nb;
 			bdwrite(bp);
+			new++;
 		} else
 			brelse(bp);
 	}
 
 	/*
-	 * calculate read-ahead.
+	 * calculate read-ahead,
+	 * and remember the run of contiguous
+	 * blocks that starts here.
 	 */
 	if(i < NINDIR-1)
 		rablock = bap[i+1];
+	if(new) {
+		ip->i_un.i_clen = 0;
+		return(nb);
+	}
+	for(j = i+1; j < NINDIR && bap[j] == nb+(j-i); j++)
+		;
+	ip->i_un.i_cbn = lbn;
+	ip->i_un.i_cpbn = nb;
+	ip->i_un.i_clen = j-i;
+	ip->i_un.i_cnext = j < NINDIR? bap[j]: 0;
+	ip->i_un.i_clev = lev;
 	return(nb);
 }
 
@@ -36,6 +36,7 @@ exece()
 
 	if ((ip = namei(uchar, 0)) == NULL)
 		return;
+	aiodrain();
 	bno = 0;
 	bp = 0;
 	if(access(ip, IEXEC))
@@ -148,6 +149,7 @@ register struct inode *ip;
 	register sep;
 	register unsigned ts, ss;
 	register i, overlay;
+	int dl;
 	long lsize;
 
 	/*
@@ -175,6 +177,7 @@ register struct inode *ip;
 	}
 	sep = 0;
 	overlay = 0;
+	dl = 0;
 	if(u.u_exdata.ux_mag == 0407) {
 		lsize = (long)u.u_exdata.ux_dsize + u.u_exdata.ux_tsize;
 		u.u_exdata.ux_dsize = lsize;
@@ -217,6 +220,7 @@ register struct inode *ip;
 		ds = u.u_dsize;
 		ss = u.u_ssize;
 		sep = u.u_sep;
+		fmclear(0);
 		xfree();
 		xalloc(ip);
 		u.u_ar0[PC] = u.u_exdata.ux_entloc & ~01;
@@ -231,6 +235,9 @@ register struct inode *ip;
 		 */
 	
 		u.u_prof.pr_scale = 0;
+		if (u.u_vfork)
+			vfrelse();
+		fmclear(0);
 		xfree();
 		i = USIZE+ds+ss;
 		expand(i);
@@ -239,14 +246,25 @@ register struct inode *ip;
 		xalloc(ip);
 	
 		/*
-		 * read in data segment
+		 * read in data segment, unless
+		 * it can be left to be read as
+		 * it is touched: for pure programs,
+		 * whose files cannot be written while
+		 * they run, when not traced, and not
+		 * on the 11/40, which cannot restart
+		 * the instruction that touches it
 		 */
 	
-		estabur((unsigned)0, ds, (unsigned)0, 0, RO);
-		u.u_base = 0;
-		u.u_offset = sizeof(u.u_exdata)+u.u_exdata.ux_tsize;
-		u.u_count = u.u_exdata.ux_dsize;
-		readi(ip);
+		if(u.u_exdata.ux_tsize && cputype != 40 &&
+		   (u.u_procp->p_flag&STRC) == 0)
+			dl++;
+		else {
+			estabur((unsigned)0, ds, (unsigned)0, 0, RO);
+			u.u_base = 0;
+			u.u_offset = sizeof(u.u_exdata)+u.u_exdata.ux_tsize;
+			u.u_count = u.u_exdata.ux_dsize;
+			readx(ip);
+		}
 		/*
 		 * set SUID/SGID protections, if no tracing
 		 */
@@ -266,6 +284,9 @@ register struct inode *ip;
 	u.u_ssize = ss;
 	u.u_sep = sep;
 	estabur(ts, ds, ss, sep, RO);
+	if(dl)
+		dlset(ip, (off_t)sizeof(u.u_exdata)+u.u_exdata.ux_tsize,
+		    u.u_exdata.ux_dsize);
 bad:
 	return(overlay);
 }
@@ -290,7 +311,7 @@ setregs()
 	for(i=0; i<NOFILE; i++) {
 		if (u.u_pofile[i]&EXCLOSE) {
 			closef(u.u_ofile[i]);
-			u.u_ofile[i] = NULL;
+			ufree(i);
 			u.u_pofile[i] &= ~EXCLOSE;
 		}
 	}
@@ -331,6 +352,9 @@ exit(rv)
 	p = u.u_procp;
 	p->p_flag &= ~(STRC|SULOCK);
 	p->p_clktim = 0;
+	aiodrain();
+	fmclear(0);
+	dlrele();
 	for(i=0; i<NSIG; i++)
 		u.u_signal[i] = 1;
 	for(i=0; i<NOFILE; i++) {
@@ -346,6 +370,8 @@ exit(rv)
 	}
 	xfree();
 	acct();
+	if (u.u_vfork)
+		vfrelse();
 	mfree(coremap, p->p_size, p->p_addr);
 	p->p_stat = SZOMB;
 	((struct xproc *)p)->xp_xstat = rv;
@@ -420,6 +446,24 @@ loop:
  * fork system call.
  */
 fork()
+{
+
+	fork1(0);
+}
+
+/*
+ * vfork system call.
+ * Like fork, but the child runs in the
+ * parent's memory until it execs or exits;
+ * the parent waits until then.
+ */
+vfork()
+{
+
+	fork1(1);
+}
+
+fork1(isvfork)
 {
 	register struct proc *p1, *p2;
 	register a;
@@ -453,18 +497,34 @@ fork()
 		u.u_error = EAGAIN;
 		goto out;
 	}
+	/*
+	 * A vfork child has no image
+	 * of its own to copy or lend.
+	 */
+	if (u.u_vfork) {
+		u.u_error = EAGAIN;
+		goto out;
+	}
 	p1 = u.u_procp;
-	if(newproc()) {
+	if(newproc(isvfork)) {
 		u.u_r.r_val1 = p1->p_pid;
 		u.u_start = time;
 		u.u_cstime = 0;
 		u.u_stime = 0;
 		u.u_cutime = 0;
 		u.u_utime = 0;
+		u.u_ior = 0;
+		u.u_iow = 0;
+		u.u_iohit = 0;
+		u.u_iowt = 0;
+		u.u_abp = NULL;
+		fmclear(1);
 		u.u_acflag = AFORK;
 		return;
 	}
 	u.u_r.r_val1 = p2->p_pid;
+	while(p1->p_flag & SVFORK)
+		sleep((caddr_t)p1, PZERO);
 
 out:
 	u.u_ar0[R7] += NBPW;
@@ -482,6 +542,14 @@ sbreak()
 	register a, n, d;
 	int i;
 
+	/*
+	 * a vfork child may not change
+	 * the size of its parent's image
+	 */
+	if(u.u_vfork) {
+		u.u_error = ENOMEM;
+		return;
+	}
 	/*
 	 * set n to new data size
 	 * set d to new-old
@@ -521,3 +589,17 @@ bigger:
 	while(d--)
 		clearseg(--a);
 }
+
+/*
+ * A vfork child gives back its
+ * parent's image, on exec or exit.
+ */
+vfrelse()
+{
+	register struct proc *p;
+
+	p = u.u_vfork;
+	u.u_vfork = NULL;
+	p->p_flag &= ~(SVFORK|SLOCK);
+	wakeup((caddr_t)p);
+}
@@ -5,6 +5,8 @@
 #include "../h/reg.h"
 #include "../h/file.h"
 #include "../h/inode.h"
+#include "../h/buf.h"
+#include "../h/uio.h"
 
 /*
  * read system call
@@ -24,54 +26,221 @@ write()
 
 /*
  * common code for read and write calls:
- * check permissions, set base, count, and offset,
- * and switch out to readi, writei, or pipe code.
+ * make a vector of the one buffer.
  */
 rdwr(mode)
-register mode;
 {
-	register struct file *fp;
-	register struct inode *ip;
 	register struct a {
 		int	fdes;
 		char	*cbuf;
 		unsigned count;
 	} *uap;
+	struct iovec aiov;
 
 	uap = (struct a *)u.u_ap;
-	fp = getf(uap->fdes);
+	aiov.iov_base = (caddr_t)uap->cbuf;
+	aiov.iov_len = uap->count;
+	rwvec(uap->fdes, mode, &aiov, 1);
+}
+
+/*
+ * readv system call
+ */
+readv()
+{
+	rdwrv(FREAD);
+}
+
+/*
+ * writev system call
+ */
+writev()
+{
+	rdwrv(FWRITE);
+}
+
+/*
+ * common code for readv and writev calls:
+ * fetch the user's vector and check
+ * that the total count fits.
+ */
+rdwrv(mode)
+{
+	register struct a {
+		int	fdes;
+		struct	iovec *iovp;
+		int	iovcnt;
+	} *uap;
+	register i;
+	unsigned n;
+	struct iovec aiov[MAXIOV];
+
+	uap = (struct a *)u.u_ap;
+	if(uap->iovcnt <= 0 || uap->iovcnt > MAXIOV) {
+		u.u_error = EINVAL;
+		return;
+	}
+	if(copyin((caddr_t)uap->iovp, (caddr_t)aiov,
+	    uap->iovcnt*sizeof(struct iovec))) {
+		u.u_error = EFAULT;
+		return;
+	}
+	n = 0;
+	for(i=0; i<uap->iovcnt; i++) {
+		if(n+aiov[i].iov_len < n) {
+			u.u_error = EINVAL;
+			return;
+		}
+		n += aiov[i].iov_len;
+	}
+	rwvec(uap->fdes, mode, aiov, uap->iovcnt);
+}
+
+/*
+ * aio system call: asynchronous raw I/O.
+ * AIOREAD and AIOWRITE start a transfer as read
+ * and write would and return a handle for it.
+ * On a raw device the transfer goes on while the
+ * process runs; anything else is finished before
+ * the call returns.  AIOWAIT waits for the transfer
+ * with the handle given and returns its count;
+ * AIOPOLL returns 1 if it has finished, else 0.
+ */
+aio()
+{
+	register struct a {
+		int	cmd;
+		int	arg;
+		caddr_t	buf;
+		unsigned count;
+	} *uap;
+	register struct buf *bp;
+	struct iovec aiov;
+	struct buf *aioget();
+
+	uap = (struct a *)u.u_ap;
+	switch(uap->cmd) {
+
+	case AIOREAD:
+	case AIOWRITE:
+		if((bp = aioget()) == NULL) {
+			u.u_error = EAGAIN;
+			return;
+		}
+		aiov.iov_base = uap->buf;
+		aiov.iov_len = uap->count;
+		u.u_abp = bp;
+		rwvec(uap->arg, uap->cmd==AIOREAD? FREAD: FWRITE, &aiov, 1);
+		if(u.u_abp != NULL) {
+			/*
+			 * physio did not take it
+			 */
+			u.u_abp = NULL;
+			bp->b_flags |= B_DONE;
+			bp->b_bcount = u.u_r.r_val1;
+			bp->b_resid = 0;
+			if(u.u_error) {
+				aiowait(bp);
+				return;
+			}
+		}
+		u.u_r.r_val1 = bp - aiobuf;
+		return;
+
+	case AIOWAIT:
+	case AIOPOLL:
+		if((unsigned)uap->arg >= NAIO ||
+		    aioowner[uap->arg] != u.u_procp) {
+			u.u_error = EINVAL;
+			return;
+		}
+		bp = &aiobuf[uap->arg];
+		if(uap->cmd == AIOPOLL)
+			u.u_r.r_val1 = (bp->b_flags&B_DONE) != 0;
+		else
+			u.u_r.r_val1 = aiowait(bp);
+		return;
+	}
+	u.u_error = EINVAL;
+}
+
+/*
+ * common code for read, write, readv, writev and aio:
+ * check permissions, set offset, then for each
+ * buffer in turn set base and count and switch
+ * out to readi, writei, or pipe code.
+ * Buffers that follow one another in memory
+ * are passed down as one, so a raw device moves
+ * them in a single physio transfer.
+ * The transfer ends at the first buffer
+ * not filled or emptied completely; a read
+ * from a pipe or character device ends at
+ * the first that gets anything, as it would
+ * otherwise wait for more.
+ */
+rwvec(fdes, mode, iov, iovcnt)
+register struct iovec *iov;
+{
+	register struct file *fp;
+	register struct inode *ip;
+	struct iovec *iove;
+	unsigned n, total;
+	int stream;
+
+	fp = getf(fdes);
 	if(fp == NULL)
 		return;
 	if((fp->f_flag&mode) == 0) {
 		u.u_error = EBADF;
 		return;
 	}
-	u.u_base = (caddr_t)uap->cbuf;
-	u.u_count = uap->count;
-	u.u_segflg = 0;
-	if((fp->f_flag&FPIPE) != 0) {
-		if(mode == FREAD)
-			readp(fp);
-		else
-			writep(fp);
-	} else {
-		ip = fp->f_inode;
+	ip = fp->f_inode;
+	stream = (fp->f_flag&FPIPE) || (ip->i_mode&IFMT) == IFCHR ||
+	    (ip->i_mode&IFMT) == IFMPC;
+	if((fp->f_flag&FPIPE) == 0) {
 		if (fp->f_flag&FMP)
 			u.u_offset = 0;
 		else
 			u.u_offset = fp->f_un.f_offset;
 		if((ip->i_mode&(IFCHR&IFBLK)) == 0)
 			plock(ip);
-		if(mode == FREAD)
-			readi(ip);
-		else
-			writei(ip);
+	}
+	u.u_segflg = 0;
+	total = 0;
+	for(iove = iov+iovcnt; iov < iove; ) {
+		u.u_base = iov->iov_base;
+		u.u_count = iov->iov_len;
+		for(iov++; iov < iove; iov++) {
+			if(iov->iov_base != u.u_base+u.u_count)
+				break;
+			u.u_count += iov->iov_len;
+		}
+		if((n = u.u_count) == 0)
+			continue;
+		if((fp->f_flag&FPIPE) != 0) {
+			if(mode == FREAD)
+				readp(fp);
+			else
+				writep(fp);
+		} else {
+			if(mode == FREAD)
+				readi(ip);
+			else
+				writei(ip);
+		}
+		total += n-u.u_count;
+		if(u.u_error || u.u_count)
+			break;
+		if(stream && mode == FREAD && total)
+			break;
+	}
+	if((fp->f_flag&FPIPE) == 0) {
 		if((ip->i_mode&(IFCHR&IFBLK)) == 0)
 			prele(ip);
 		if ((fp->f_flag&FMP) == 0)
-			fp->f_un.f_offset += uap->count-u.u_count;
+			fp->f_un.f_offset += total;
 	}
-	u.u_r.r_val1 = uap->count-u.u_count;
+	u.u_r.r_val1 = total;
 }
 
 /*
@@ -150,8 +319,8 @@ register mode;
 	openi(ip, mode&FWRITE);
 	if(u.u_error == 0)
 		return;
-	u.u_ofile[i] = NULL;
-	fp->f_count--;
+	ufree(i);
+	ffree(fp);
 
 out:
 	iput(ip);
@@ -171,7 +340,7 @@ close()
 	fp = getf(uap->fdes);
 	if(fp == NULL)
 		return;
-	u.u_ofile[uap->fdes] = NULL;
+	ufree(uap->fdes);
 	closef(fp);
 }
 
@@ -246,7 +415,7 @@ link()
 	wdir(ip);
 	if (u.u_error==0) {
 		ip->i_nlink++;
-		ip->i_flag |= ICHG;
+		imark(ip, ICHG);
 	}
 
 out:
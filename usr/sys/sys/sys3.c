@@ -208,6 +208,7 @@ sumount()
 	if(u.u_error)
 		return;
 	xumount(dev);	/* remove unused sticky files from text table */
+	itrwait(dev);
 	update();
 	for(mp = &mount[0]; mp < &mount[NMOUNT]; mp++)
 		if(mp->m_bufp != NULL && dev == mp->m_dev)
@@ -216,11 +217,11 @@ sumount()
 	return;
 
 found:
-	for(ip = &inode[0]; ip < &inode[NINODE]; ip++)
-		if(ip->i_number != 0 && dev == ip->i_dev) {
-			u.u_error = EBUSY;
-			return;
-		}
+	if(iflush(dev)) {
+		u.u_error = EBUSY;
+		return;
+	}
+	ncinval(dev, (ino_t)0);
 	(*bdevsw[major(dev)].d_close)(dev, 0);
 	ip = mp->m_inodp;
 	ip->i_flag &= ~IMOUNT;
@@ -178,13 +178,14 @@ unlink()
 		u.u_error = ETXTBSY;
 		goto out;
 	}
+	ncpurge(pp);
 	u.u_offset -= sizeof(struct direct);
 	u.u_base = (caddr_t)&u.u_dent;
 	u.u_count = sizeof(struct direct);
 	u.u_dent.d_ino = 0;
 	writei(pp);
 	ip->i_nlink--;
-	ip->i_flag |= ICHG;
+	imark(ip, ICHG);
 
 out:
 	iput(ip);
@@ -246,7 +247,7 @@ chmod()
 	if (u.u_uid)
 		uap->fmode &= ~ISVTX;
 	ip->i_mode |= uap->fmode&07777;
-	ip->i_flag |= ICHG;
+	imark(ip, ICHG);
 	if (ip->i_flag&ITEXT && (ip->i_mode&ISVTX)==0)
 		xrele(ip);
 	iput(ip);
@@ -266,7 +267,7 @@ chown()
 		return;
 	ip->i_uid = uap->uid;
 	ip->i_gid = uap->gid;
-	ip->i_flag |= ICHG;
+	imark(ip, ICHG);
 	iput(ip);
 }
 
@@ -416,7 +417,7 @@ utime()
 		u.u_error = EFAULT;
 		return;
 	}
-	ip->i_flag |= IACC|IUPD|ICHG;
+	imark(ip, IACC|IUPD|ICHG);
 	iupdat(ip, &tv[0], &tv[1]);
 	iput(ip);
 }
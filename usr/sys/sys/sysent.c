@@ -7,6 +7,7 @@
  * Each row contains the number of arguments expected
  * and a pointer to the routine.
  */
+int	aio();
 int	alarm();
 int	mpxchan();
 int	chdir();
@@ -18,7 +19,9 @@ int	creat();
 int	dup();
 int	exec();
 int	exece();
+int	fmap();
 int	fork();
+int	vfork();
 int	fstat();
 int	getgid();
 int	getpid();
@@ -38,6 +41,7 @@ int	pipe();
 int	profil();
 int	ptrace();
 int	read();
+int	readv();
 int	rexit();
 int	saccess();
 int	sbreak();
@@ -61,6 +65,7 @@ int	unlink();
 int	utime();
 int	wait();
 int	write();
+int	writev();
 
 struct sysent sysent[64] =
 {
@@ -104,17 +109,17 @@ struct sysent sysent[64] =
 	2, 1, kill,			/* 37 = kill */
 	0, 0, nullsys,			/* 38 = switch; inoperative */
 	0, 0, nullsys,			/* 39 = setpgrp (not in yet) */
-	1, 1, nosys,			/* 40 = tell (obsolete) */
+	3, 1, readv,			/* 40 = readv; formerly tell */
 	2, 2, dup,			/* 41 = dup */
 	0, 0, pipe,			/* 42 = pipe */
 	1, 0, times,			/* 43 = times */
 	4, 0, profil,			/* 44 = prof */
-	0, 0, nosys,			/* 45 = unused */
+	0, 0, vfork,			/* 45 = vfork */
 	1, 1, setgid,			/* 46 = setgid */
 	0, 0, getgid,			/* 47 = getgid */
 	2, 0, ssig,			/* 48 = sig */
-	0, 0, nosys,			/* 49 = reserved for USG */
-	0, 0, nosys,			/* 50 = reserved for USG */
+	4, 0, aio,			/* 49 = aio; formerly reserved for USG */
+	3, 1, fmap,			/* 50 = fmap; formerly reserved for USG */
 	1, 0, sysacct,			/* 51 = turn acct off/on */
 	3, 0, sysphys,			/* 52 = set user physical addresses */
 	1, 0, syslock,			/* 53 = lock user in core */
@@ -126,6 +131,6 @@ struct sysent sysent[64] =
 	3, 0, exece,			/* 59 = exece */
 	1, 0, umask,			/* 60 = umask */
 	1, 0, chroot,			/* 61 = chroot */
-	0, 0, nosys,			/* 62 = x */
+	3, 1, writev,			/* 62 = writev */
 	0, 0, nosys			/* 63 = used internally */
 };
@@ -9,6 +9,22 @@
 #include "../h/buf.h"
 #include "../h/seg.h"
 
+/*
+ * Texts are found by hashing their inode.
+ * When the last process using a text exits, the
+ * text is kept (XCACHE), in core if it still is,
+ * for the next exec of the same file; up to NXCACHE
+ * are kept, and the least recently used is dropped
+ * when there are more or the table is full.
+ * The swapper takes back the core of cached texts
+ * before it swaps processes out.
+ */
+struct	text	*xhash[XHSZ];
+struct	text	*xlruh;		/* least recently used cached text */
+struct	text	*xlrut;		/* most recently used */
+int	nxcache;
+struct	xstats	xstats;
+
 /*
  * Swap out process p.
  * The ff flag causes its core to be freed--
@@ -16,10 +32,25 @@
  * child process in newproc.
  * Os is the old size of the data area of the process,
  * and is supplied during core expansion swaps.
+ */
+xswap(p, ff, os)
+register struct proc *p;
+{
+	register a;
+
+	a = xswout(p, os);
+	swwait();
+	xswdone(p, ff, os, a);
+}
+
+/*
+ * Start writing the image of p to swap,
+ * and return the swap address; the swapper
+ * starts several before waiting for them.
  *
  * panic: out of swap space
  */
-xswap(p, ff, os)
+xswout(p, os)
 register struct proc *p;
 {
 	register a;
@@ -31,7 +62,20 @@ register struct proc *p;
 		panic("out of swap space");
 	p->p_flag |= SLOCK;
 	xccdec(p->p_textp);
-	swap(a, p->p_addr, os, B_WRITE);
+	swstart(a, p->p_addr, os, B_WRITE);
+	return(a);
+}
+
+/*
+ * Finish swapping p out to swap
+ * address a, after swwait.
+ */
+xswdone(p, ff, os, a)
+register struct proc *p;
+{
+
+	if(os == 0)
+		os = p->p_size;
 	if(ff)
 		mfree(coremap, os, p->p_addr);
 	p->p_addr = a;
@@ -59,6 +103,16 @@ xfree()
 	u.u_procp->p_textp = NULL;
 	ip = xp->x_iptr;
 	if(--xp->x_count==0 && (ip->i_mode&ISVTX)==0) {
+		/*
+		 * Keep it for the next exec, with our
+		 * core reference, unless it was changed
+		 * by ptrace.
+		 */
+		if (ip->i_flag&ITEXT) {
+			xcache(xp);
+			return;
+		}
+		xunhash(xp);
 		xp->x_iptr = NULL;
 		mfree(swapmap, ctod(xp->x_size), xp->x_daddr);
 		mfree(coremap, xp->x_size, xp->x_caddr);
@@ -76,7 +130,8 @@ xfree()
  * If there is no shared text, just return.
  * If there is, hook up to it:
  * if it is not currently being used, it has to be read
- * in from the inode (ip); the written bit is set to force it
+ * in from the inode (ip), straight to core by readx where it
+ * can be; the written bit is set to force it
  * to be written out as appropriate.
  * If it is being used, but is not currently in core,
  * a swap has to be done to get it back.
@@ -86,21 +141,29 @@ register struct inode *ip;
 {
 	register struct text *xp;
 	register unsigned ts;
-	register struct text *xp1;
 
 	if(u.u_exdata.ux_tsize == 0)
 		return;
-	xp1 = NULL;
-	for (xp = &text[0]; xp < &text[NTEXT]; xp++) {
-		if(xp->x_iptr == NULL) {
-			if(xp1 == NULL)
-				xp1 = xp;
-			continue;
-		}
+	xstats.xs_alloc++;
+	for (xp = xhash[XHASH(ip)]; xp != NULL; xp = xp->x_hlink) {
 		if(xp->x_iptr == ip) {
 			xlock(xp);
 			xp->x_count++;
 			u.u_procp->p_textp = xp;
+			if (xp->x_flag&XCACHE) {
+				xstats.xs_chit++;
+				xuncache(xp);
+				/*
+				 * The cache's core reference,
+				 * if any, becomes ours.
+				 */
+				if (xp->x_ccount) {
+					xstats.xs_ccore++;
+					xunlock(xp);
+					return;
+				}
+			} else
+				xstats.xs_hit++;
 			if (xp->x_ccount == 0)
 				xexpand(xp);
 			else
@@ -109,15 +172,26 @@ register struct inode *ip;
 			return;
 		}
 	}
-	if((xp=xp1) == NULL) {
-		printf("out of text");
-		psignal(u.u_procp, SIGKIL);
-		return;
+	xstats.xs_miss++;
+	for (;;) {
+		for (xp = &text[0]; xp < &text[NTEXT]; xp++)
+			if(xp->x_iptr == NULL)
+				break;
+		if (xp < &text[NTEXT])
+			break;
+		if (xlruh == NULL) {
+			printf("out of text");
+			psignal(u.u_procp, SIGKIL);
+			return;
+		}
+		xstats.xs_evict++;
+		xuntext(xlruh);
 	}
 	xp->x_flag = XLOAD|XLOCK;
 	xp->x_count = 1;
 	xp->x_ccount = 0;
 	xp->x_iptr = ip;
+	xhashin(xp);
 	ip->i_flag |= ITEXT;
 	ip->i_count++;
 	ts = btoc(u.u_exdata.ux_tsize);
@@ -132,7 +206,7 @@ register struct inode *ip;
 	u.u_base = 0;
 	u.u_segflg = 2;
 	u.u_procp->p_flag |= SLOCK;
-	readi(ip);
+	readx(ip);
 	u.u_procp->p_flag &= ~SLOCK;
 	u.u_segflg = 0;
 	xp->x_flag = XWRIT;
@@ -231,11 +305,13 @@ register struct inode *ip;
 {
 	register struct text *xp;
 
-	if (ip->i_flag&ITEXT==0)
+	if ((ip->i_flag&ITEXT)==0)
 		return;
-	for (xp = &text[0]; xp < &text[NTEXT]; xp++)
-		if (ip==xp->x_iptr)
+	for (xp = xhash[XHASH(ip)]; xp != NULL; xp = xp->x_hlink)
+		if (ip==xp->x_iptr) {
 			xuntext(xp);
+			return;
+		}
 }
 
 /*
@@ -248,12 +324,20 @@ register struct text *xp;
 	register struct inode *ip;
 
 	xlock(xp);
-	if (xp->x_count) {
+	if (xp->x_count || xp->x_iptr == NULL) {
 		xunlock(xp);
 		return;
 	}
+	if (xp->x_flag&XCACHE) {
+		xuncache(xp);
+		if (xp->x_ccount) {
+			mfree(coremap, xp->x_size, xp->x_caddr);
+			xp->x_ccount = 0;
+		}
+	}
 	ip = xp->x_iptr;
 	xp->x_flag &= ~XLOCK;
+	xunhash(xp);
 	xp->x_iptr = NULL;
 	mfree(swapmap, ctod(xp->x_size), xp->x_daddr);
 	ip->i_flag &= ~ITEXT;
@@ -262,3 +346,94 @@ register struct text *xp;
 	else
 		iput(ip);
 }
+
+/*
+ * Put xp, whose last user has gone, at the
+ * recently used end of the cache, dropping
+ * the oldest if there are too many.
+ */
+xcache(xp)
+register struct text *xp;
+{
+
+	xp->x_flag |= XCACHE;
+	xp->x_lforw = NULL;
+	if ((xp->x_lback = xlrut) == NULL)
+		xlruh = xp; else
+		xlrut->x_lforw = xp;
+	xlrut = xp;
+	if (++nxcache > NXCACHE) {
+		xstats.xs_evict++;
+		xuntext(xlruh);
+	}
+}
+
+/*
+ * Take xp out of the cache.
+ */
+xuncache(xp)
+register struct text *xp;
+{
+
+	if (xp->x_lforw)
+		xp->x_lforw->x_lback = xp->x_lback; else
+		xlrut = xp->x_lback;
+	if (xp->x_lback)
+		xp->x_lback->x_lforw = xp->x_lforw; else
+		xlruh = xp->x_lforw;
+	xp->x_flag &= ~XCACHE;
+	nxcache--;
+}
+
+/*
+ * Give up the core of cached texts, oldest
+ * first, until n clicks are freed; they stay
+ * cached on swap.  Returns the clicks freed.
+ * Called by the swapper when core is short.
+ */
+xcreclaim(n)
+{
+	register struct text *xp;
+	register f;
+
+	f = 0;
+	while (f < n) {
+		for (xp = xlruh; xp != NULL; xp = xp->x_lforw)
+			if (xp->x_ccount && (xp->x_flag&XLOCK)==0)
+				break;
+		if (xp == NULL)
+			break;
+		xstats.xs_reclaim++;
+		f += xp->x_size;
+		xccdec(xp);
+	}
+	return(f);
+}
+
+/*
+ * Enter xp in the hash chain for its inode.
+ */
+xhashin(xp)
+register struct text *xp;
+{
+	register struct text **hp;
+
+	hp = &xhash[XHASH(xp->x_iptr)];
+	xp->x_hlink = *hp;
+	*hp = xp;
+}
+
+/*
+ * Remove xp from its hash chain.
+ */
+xunhash(xp)
+register struct text *xp;
+{
+	register struct text **hp;
+
+	for (hp = &xhash[XHASH(xp->x_iptr)]; *hp != NULL; hp = &(*hp)->x_hlink)
+		if (*hp == xp) {
+			*hp = xp->x_hlink;
+			return;
+		}
+}
@@ -102,6 +102,13 @@ dev_t dev;
 		ps &= ~EBIT;
 		a = pc;
 		callp = &sysent[fuiword((caddr_t)(a-1))&077];
+		/*
+		 * The kernel cannot fault in data pages
+		 * exec left unread, so those left are read
+		 * now, except for exit, which drops them.
+		 */
+		if (u.u_dlpage && callp != &sysent[1])
+			dlfill(u.u_dlpage);
 		if (callp == sysent) { /* indirect */
 			a = (int *)fuiword((caddr_t)(a));
 			pc++;
@@ -126,6 +133,7 @@ dev_t dev;
 		if (save(u.u_qsav)) {
 			if (u.u_error==0)
 				u.u_error = EINTR;
+			aioclear();
 		} else {
 			(*callp->sy_call)();
 		}
@@ -172,7 +180,7 @@ dev_t dev;
 
 		osp = sp;
 		if(backup(u.u_ar0) == 0)
-			if(grow((unsigned)osp))
+			if(grow((unsigned)osp) || fmfault() || dlfault())
 				goto out;
 		i = SIGSEG;
 		break;
@@ -20,6 +20,8 @@ sureg()
 	struct text *tp;
 
 	taddr = daddr = u.u_procp->p_addr;
+	if (u.u_vfork)
+		daddr = u.u_vfork->p_addr;
 	if ((tp=u.u_procp->p_textp) != NULL)
 		taddr = tp->x_caddr;
 	limudp = &u.u_uisd[16];